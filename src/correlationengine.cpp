@@ -0,0 +1,174 @@
+#include "correlationengine.h"
+#include "entityextractor.h"
+#include "templateminer.h"
+#include <algorithm>
+#include <utility>
+
+QVector<CorrelationRule> CorrelationEngine::builtinRules() {
+    CorrelationRule bruteForce;
+    bruteForce.id          = "brute_force";
+    bruteForce.severity    = "critical";
+    bruteForce.category    = "Authentication";
+    bruteForce.description = "%1 authentication failures from %2 within %3 s";
+    bruteForce.threatId    = "auth_failure";
+    // sshd "from <addr>", PAM "rhost=<addr>"; IPv4 or IPv6
+    bruteForce.pattern     = QRegularExpression(
+        R"((?:\bfrom|\brhost=)\s*(?<key>(?:\d{1,3}\.){3}\d{1,3}|[0-9A-Fa-f]*:[0-9A-Fa-f:]+))");
+    bruteForce.threshold   = 20;
+    bruteForce.windowUsec  = 60 * 1000000LL;
+
+    // systemd logs this once per failed start, restarts included
+    CorrelationRule restartLoop;
+    restartLoop.id          = "restart_loop";
+    restartLoop.severity    = "high";
+    restartLoop.category    = "Stability";
+    restartLoop.description = "%2 failed %1 times within %3 s";
+    restartLoop.literal     = "Failed with result";
+    restartLoop.pattern     = QRegularExpression(R"(^(?<key>\S+): Failed with result)");
+    restartLoop.threshold   = 10;
+    restartLoop.windowUsec  = 5 * 60 * 1000000LL;
+
+    return {bruteForce, restartLoop};
+}
+
+CorrelationEngine::CorrelationEngine(const QVector<CorrelationRule>& rules, int maxKeys)
+    : m_rules(rules), m_maxKeys(qMax(1, maxKeys)) {
+    for (auto& rule : m_rules) rule.pattern.optimize();
+}
+
+void CorrelationEngine::clear() {
+    m_lru.clear();
+    m_index.clear();
+    m_evicted = 0;
+}
+
+int CorrelationEngine::process(QVector<LogEntry>& entries, Order order) {
+    // (storage index of the trigger, event)
+    QVector<std::pair<int, LogEntry>> events;
+
+    const int count = entries.size();
+    for (int step = 0; step < count; ++step) {
+        const int i = order == Order::AsStored ? step : count - 1 - step;
+        const LogEntry& entry = entries[i];
+        if (entry.source == "correlation") continue;
+
+        for (int r = 0; r < m_rules.size(); ++r) {
+            const CorrelationRule& rule = m_rules[r];
+            if (!rule.threatId.isEmpty()
+                && std::none_of(entry.threats.begin(), entry.threats.end(),
+                                [&rule](const ThreatMatch& t) { return t.id == rule.threatId; }))
+                continue;
+            if (!rule.literal.isEmpty() && !entry.message.contains(rule.literal)) continue;
+
+            QString key = entry.unit;
+            if (!rule.pattern.pattern().isEmpty()) {
+                const QRegularExpressionMatch match = rule.pattern.match(entry.message);
+                if (!match.hasMatch()) continue;
+                const QString captured = match.captured("key");
+                if (!captured.isEmpty()) key = captured;
+            }
+
+            LogEntry event;
+            if (feed(r, key, entry, event)) events.append({i, std::move(event)});
+        }
+    }
+    if (events.isEmpty()) return 0;
+
+    std::stable_sort(events.begin(), events.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    QVector<LogEntry> merged;
+    merged.reserve(count + events.size());
+    int next = 0;
+    for (int i = 0; i < count; ++i) {
+        while (next < events.size() && events[next].first == i)
+            merged.append(std::move(events[next++].second));
+        merged.append(std::move(entries[i]));
+    }
+    entries = std::move(merged);
+    return events.size();
+}
+
+bool CorrelationEngine::feed(int r, const QString& key, const LogEntry& entry, LogEntry& event) {
+    const CorrelationRule& rule = m_rules[r];
+    KeyState& state = stateFor(QString::number(r) + QChar(0x1f) + key);
+    const qint64 usec = entry.timestampUsec;
+
+    // The feed is monotonic in one direction or the other, so the entries
+    // furthest from this one in time are at the front
+    while (!state.times.empty() && qAbs(usec - state.times.front()) > rule.windowUsec)
+        state.times.pop_front();
+    state.times.push_back(usec);
+    if (int(state.times.size()) > rule.threshold) state.times.pop_front();
+    if (int(state.times.size()) < rule.threshold) return false;
+
+    // One event per window of a sustained burst
+    if (state.fired && qAbs(usec - state.firedUsec) <= rule.windowUsec) return false;
+    state.fired = true;
+    state.firedUsec = usec;
+
+    event = correlatedEntry(rule, key, int(state.times.size()), entry);
+    return true;
+}
+
+CorrelationEngine::KeyState& CorrelationEngine::stateFor(const QString& key) {
+    const auto it = m_index.constFind(key);
+    if (it != m_index.constEnd()) {
+        m_lru.splice(m_lru.begin(), m_lru, it.value());
+        return m_lru.front();
+    }
+
+    if (int(m_lru.size()) >= m_maxKeys) {
+        m_index.remove(m_lru.back().key);
+        m_lru.pop_back();
+        ++m_evicted;
+    }
+    m_lru.push_front(KeyState());
+    m_lru.front().key = key;
+    m_index.insert(key, m_lru.begin());
+    return m_lru.front();
+}
+
+LogEntry CorrelationEngine::correlatedEntry(const CorrelationRule& rule, const QString& key,
+                                            int count, const LogEntry& trigger) {
+    LogEntry entry;
+    entry.source        = "correlation";
+    entry.transport     = "correlation";
+    entry.timestampUsec = trigger.timestampUsec;
+    entry.unit          = trigger.unit;
+    entry.hostname      = trigger.hostname;
+    entry.bootId        = trigger.bootId;
+    // Names the burst rather than the trigger line, which can differ
+    // between scans; the key goes last since it may hold colons
+    entry.cursor        = QString("correlation:%1:%2:%3")
+                              .arg(rule.id)
+                              .arg(rule.windowUsec)
+                              .arg(key);
+
+    if (rule.severity == "critical") {
+        entry.priority = 2;
+        entry.group = "critical";
+    } else if (rule.severity == "high") {
+        entry.priority = 3;
+        entry.group = "error";
+    } else {
+        entry.priority = 4;
+        entry.group = "warning";
+    }
+
+    const qint64 windowSecs = rule.windowUsec / 1000000;
+    entry.message = rule.description.arg(QString::number(count), key, QString::number(windowSecs));
+    // Correlation runs after extraction and mining; the key is usually an
+    // entity itself
+    EntityExtractor::annotate(entry);
+    TemplateMiner::shared().annotate(entry);
+    entry.threats = {{
+        rule.id,
+        rule.severity,
+        rule.category,
+        entry.message,
+        QString("%1 in %2 s").arg(rule.threshold).arg(windowSecs)
+    }};
+    entry.threatCount = 1;
+    entry.maxThreatSeverity = rule.severity;
+    return entry;
+}
@@ -0,0 +1,88 @@
+#ifndef CORRELATIONENGINE_H
+#define CORRELATIONENGINE_H
+
+#include "logentry.h"
+#include <QHash>
+#include <QRegularExpression>
+#include <QVector>
+#include <deque>
+#include <list>
+
+// A pattern over many lines: threshold matching lines with the same key
+// within window. A line takes part when it carries threatId (if set),
+// contains literal (if set) and matches pattern (if set); the pattern's
+// "key" capture is the key, else the line's unit.
+struct CorrelationRule {
+    QString            id;
+    QString            severity;      // of the correlated event
+    QString            category;
+    QString            description;   // %1 = count, %2 = key, %3 = window in seconds
+    QString            threatId;
+    QString            literal;
+    QRegularExpression pattern;
+    int                threshold  = 10;
+    qint64             windowUsec = 60 * 1000000LL;
+};
+
+// Streaming correlation over entries that already went through threat
+// detection. Each rule keeps, per key, the timestamps of its recent
+// matching lines (never more than threshold of them); when threshold of
+// them fall within the window a synthetic entry (source "correlation") is
+// inserted into the stream next to the line that completed the burst. A
+// key fires once per window, not on every line of a long burst.
+//
+// Entries must be fed in a consistent time direction, oldest-first or
+// newest-first: a streaming scan feeds its newest-first batches as they
+// are, live deltas are fed back to front. Per-key state is bounded by an
+// LRU over keys, so a flood of distinct IPs or users evicts the coldest
+// keys instead of growing without limit.
+//
+// A synthetic entry's cursor is "correlation:<rule>:<window usec>:<key>".
+// PersistenceManager skips one when an event with that cursor is stored
+// within the window of it, so the same burst seen by two scans is stored
+// once wherever each completed it.
+class CorrelationEngine {
+public:
+    enum class Order { AsStored, Reversed };
+
+    static constexpr int kDefaultMaxKeys = 10000;
+
+    explicit CorrelationEngine(const QVector<CorrelationRule>& rules = builtinRules(),
+                               int maxKeys = kDefaultMaxKeys);
+
+    // 20 authentication failures from one address in 60 s; a unit failing
+    // 10 times in 5 minutes
+    static QVector<CorrelationRule> builtinRules();
+
+    // Feeds entries (walked back to front with Order::Reversed) and inserts
+    // the correlated events they trigger, each directly before its trigger
+    // in storage order so a time-sorted vector stays sorted. Returns how
+    // many were inserted.
+    int process(QVector<LogEntry>& entries, Order order = Order::AsStored);
+
+    void clear();
+    int trackedKeys() const { return int(m_lru.size()); }
+    quint64 evictedKeys() const { return m_evicted; }
+
+private:
+    struct KeyState {
+        QString            key;       // rule index + '\x1f' + extracted key
+        std::deque<qint64> times;     // oldest-fed at the front
+        bool               fired = false;
+        qint64             firedUsec = 0;
+    };
+
+    // The event a completed burst produces, or nothing
+    bool feed(int rule, const QString& key, const LogEntry& entry, LogEntry& event);
+    KeyState& stateFor(const QString& key);
+    static LogEntry correlatedEntry(const CorrelationRule& rule, const QString& key,
+                                    int count, const LogEntry& trigger);
+
+    QVector<CorrelationRule>  m_rules;
+    int                       m_maxKeys;
+    std::list<KeyState>       m_lru;          // most recently used first
+    QHash<QString, std::list<KeyState>::iterator> m_index;
+    quint64                   m_evicted = 0;
+};
+
+#endif // CORRELATIONENGINE_H
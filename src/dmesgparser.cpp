@@ -0,0 +1,116 @@
+#include "dmesgparser.h"
+
+// Days from 1970-01-01 to y-m-d in the proleptic Gregorian calendar
+// (H. Hinnant's days_from_civil).
+static qint64 daysFromCivil(int y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = unsigned(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return qint64(era) * 146097 + qint64(doe) - 719468;
+}
+
+static inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+static inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+static inline bool isWordChar(char c) {
+    return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+// Reads exactly n digits at p
+static inline bool digits(const char* p, int n, int& value) {
+    value = 0;
+    for (int i = 0; i < n; ++i) {
+        if (!isDigit(p[i])) return false;
+        value = value * 10 + (p[i] - '0');
+    }
+    return true;
+}
+
+// dmesg level names in priority order; unknown tags count as err
+static int priorityForLevel(const char* word, int len) {
+    static const char* const kLevels[] = {"emerg", "alert", "crit", "err", "warn"};
+    for (int prio = 0; prio < 5; ++prio) {
+        const char* name = kLevels[prio];
+        int i = 0;
+        while (i < len && name[i] && (word[i] | 0x20) == name[i]) ++i;
+        if (i == len && !name[i]) return prio;
+    }
+    return 3;
+}
+
+bool DmesgParser::parse(const char* line, size_t len, DmesgLine& out) {
+    const char* p = line;
+    const char* const end = line + len;
+
+    // yyyy-mm-ddThh:mm:ss is 19 bytes, then at least ",f+hhmm"
+    if (len < 26) return false;
+    int year, month, day, hour, minute, second;
+    if (!digits(p, 4, year) || p[4] != '-' || !digits(p + 5, 2, month) || p[7] != '-'
+        || !digits(p + 8, 2, day) || p[10] != 'T'
+        || !digits(p + 11, 2, hour) || p[13] != ':' || !digits(p + 14, 2, minute)
+        || p[16] != ':' || !digits(p + 17, 2, second))
+        return false;
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+        return false;
+    p += 19;
+
+    // Fraction: any number of digits, kept to microsecond precision
+    if (*p != ',' && *p != '.') return false;
+    ++p;
+    if (p >= end || !isDigit(*p)) return false;
+    int usec = 0, scale = 100000;
+    for (; p < end && isDigit(*p); ++p) {
+        usec += (*p - '0') * scale;
+        scale /= 10;
+    }
+
+    // UTC offset: +hhmm, also accepting +hh:mm
+    if (p >= end || (*p != '+' && *p != '-')) return false;
+    const int sign = (*p == '-') ? -1 : 1;
+    ++p;
+    int offHours, offMinutes;
+    if (end - p < 4 || !digits(p, 2, offHours)) return false;
+    p += 2;
+    if (*p == ':') ++p;
+    if (end - p < 2 || !digits(p, 2, offMinutes)) return false;
+    p += 2;
+
+    // At least one blank, then something to report
+    if (p >= end || !isSpace(*p)) return false;
+    while (p < end && isSpace(*p)) ++p;
+    if (p >= end) return false;
+
+    const int date = year * 10000 + month * 100 + day;
+    if (date != m_cachedDate) {
+        m_cachedDate = date;
+        m_cachedDayEpoch = daysFromCivil(year, unsigned(month), unsigned(day)) * 86400;
+    }
+    const qint64 secs = m_cachedDayEpoch + hour * 3600 + minute * 60 + second
+                      - sign * (offHours * 3600 + offMinutes * 60);
+    out.epochUsec = secs * 1000000 + usec;
+
+    // Optional "[ level ]" tag in front of the message
+    out.priority = 3;
+    const char* tag = p;
+    if (*tag == '[') {
+        ++tag;
+        while (tag < end && isSpace(*tag)) ++tag;
+        const char* word = tag;
+        while (tag < end && isWordChar(*tag)) ++tag;
+        const char* wordEnd = tag;
+        while (tag < end && isSpace(*tag)) ++tag;
+        if (wordEnd > word && tag < end && *tag == ']') {
+            out.priority = priorityForLevel(word, int(wordEnd - word));
+            p = tag + 1;
+            while (p < end && isSpace(*p)) ++p;
+        }
+    }
+
+    // Trailing CR/blanks are not part of the message
+    const char* messageEnd = end;
+    while (messageEnd > p && isSpace(messageEnd[-1])) --messageEnd;
+    out.message = p;
+    out.messageLen = int(messageEnd - p);
+    return true;
+}
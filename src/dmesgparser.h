@@ -0,0 +1,33 @@
+#ifndef DMESGPARSER_H
+#define DMESGPARSER_H
+
+#include <QtGlobal>
+#include <cstddef>
+
+// One parsed `dmesg --time-format=iso` line. message points into the
+// caller's buffer, so it is only valid as long as that buffer is.
+struct DmesgLine {
+    qint64      epochUsec  = 0;
+    int         priority   = 3;   // from a [level] tag; err when there is none
+    const char* message    = nullptr;
+    int         messageLen = 0;
+};
+
+// Single-pass parser for the fixed iso layout of the dmesg fallback:
+//
+//     2024-06-10T14:03:07,123456+0200 [  err] message text
+//
+// The timestamp is converted with integer arithmetic; the date part only
+// changes at midnight, so its epoch is cached and consecutive lines from the
+// same day cost a compare. Nothing is allocated — converting the message to
+// a QString is left to the caller, after it has decided to keep the line.
+class DmesgParser {
+public:
+    bool parse(const char* line, size_t len, DmesgLine& out);
+
+private:
+    int    m_cachedDate = -1;      // yyyymmdd of the cached day
+    qint64 m_cachedDayEpoch = 0;   // seconds since the epoch at its 00:00 UTC
+};
+
+#endif // DMESGPARSER_H
@@ -0,0 +1,98 @@
+#include "entityextractor.h"
+#include <QRegularExpression>
+
+namespace {
+
+void addEntity(QVector<LogEntity>& entities, LogEntity::Kind kind, const QString& value) {
+    for (const auto& entity : entities)
+        if (entity.kind == kind && entity.value == value) return;
+    entities.append(LogEntity{kind, value});
+}
+
+void addPort(QVector<LogEntity>& entities, QStringView digits) {
+    bool ok = false;
+    const int port = digits.toInt(&ok);
+    if (ok && port >= 1 && port <= 65535) addEntity(entities, LogEntity::Port, QString::number(port));
+}
+
+// "::" once, or eight full groups; rules out clock times and MAC addresses
+bool isIpv6(const QString& candidate) {
+    const int compressed = candidate.indexOf("::");
+    if (compressed >= 0 && candidate.indexOf("::", compressed + 1) >= 0) return false;
+    if (compressed < 0 && candidate.count(':') != 7) return false;
+    return candidate.size() > 2;
+}
+
+void extractAddresses(const QString& message, QVector<LogEntity>& entities) {
+    static const QRegularExpression ipv4(
+        R"((?<![\w.])((?:25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)(?:\.(?:25[0-5]|2[0-4]\d|1\d\d|[1-9]?\d)){3})(?!\w|\.\d)(?::(\d{1,5})(?!\d))?)",
+        QRegularExpression::OptimizeOnFirstUsageOption);
+    static const QRegularExpression ipv6(
+        R"((?<![\w:.])([0-9A-Fa-f]{0,4}(?::[0-9A-Fa-f]{0,4}){2,7})(?![\w:]|\.\d))",
+        QRegularExpression::OptimizeOnFirstUsageOption);
+
+    if (message.contains('.')) {
+        auto it = ipv4.globalMatch(message);
+        while (it.hasNext()) {
+            const auto match = it.next();
+            addEntity(entities, LogEntity::Ip, match.captured(1));
+            if (!match.capturedView(2).isEmpty()) addPort(entities, match.capturedView(2));
+        }
+    }
+    if (message.contains(':')) {
+        auto it = ipv6.globalMatch(message);
+        while (it.hasNext()) {
+            const QString candidate = it.next().captured(1);
+            if (isIpv6(candidate)) addEntity(entities, LogEntity::Ip, candidate.toLower());
+        }
+    }
+}
+
+void extractUsers(const QString& message, QVector<LogEntity>& entities) {
+    static const QRegularExpression patterns[] = {
+        // sshd: "Invalid user admin from", "Connection closed by authenticating user root"
+        QRegularExpression(R"(\b(?:[Ii]nvalid|[Ii]llegal|authenticating) user ([\w.@-]+))"),
+        // sshd: "Failed password for root from", "Accepted publickey for deploy from"
+        QRegularExpression(R"(\bfor (?!invalid user\b)([A-Za-z_][\w.@-]*) from\b)"),
+        // pam_unix: "ruser=alice rhost=... user=root"
+        QRegularExpression(R"((?<![\w-])r?user=([\w.@-]+))"),
+        // pam_unix: "session opened for user root(uid=0)"
+        QRegularExpression(R"(\bsession (?:opened|closed) for user ([\w.@-]+))"),
+        // sudo: "alice : TTY=pts/0 ; PWD=/home/alice ; USER=root ; COMMAND=/bin/ls"
+        QRegularExpression(R"(^\s*([a-z_][\w.-]*) : (?:.*; )?(?:TTY|PWD|USER|COMMAND)=)"),
+        // su: "FAILED SU (to root) alice on pts/0"
+        QRegularExpression(R"(\bSU \(to ([\w.-]+)\) ([\w.-]+) on\b)"),
+    };
+
+    if (!message.contains("user", Qt::CaseInsensitive) && !message.contains(" for ")
+        && !message.contains(" : ") && !message.contains("SU (to "))
+        return;
+
+    for (const auto& pattern : patterns) {
+        auto it = pattern.globalMatch(message);
+        while (it.hasNext()) {
+            const auto match = it.next();
+            for (int group = 1; group <= match.lastCapturedIndex(); ++group)
+                addEntity(entities, LogEntity::User, match.captured(group));
+        }
+    }
+}
+
+void extractPorts(const QString& message, QVector<LogEntity>& entities) {
+    // sshd "port 22", iptables "SPT=443 DPT=51234"
+    static const QRegularExpression ports(R"(\b(?:port |[SD]PT=)(\d{1,5})\b)");
+
+    if (!message.contains("port ") && !message.contains("PT=")) return;
+    auto it = ports.globalMatch(message);
+    while (it.hasNext()) addPort(entities, it.next().capturedView(1));
+}
+
+} // namespace
+
+QVector<LogEntity> EntityExtractor::extract(const QString& message) {
+    QVector<LogEntity> entities;
+    extractAddresses(message, entities);
+    extractUsers(message, entities);
+    extractPorts(message, entities);
+    return entities;
+}
@@ -0,0 +1,23 @@
+#ifndef ENTITYEXTRACTOR_H
+#define ENTITYEXTRACTOR_H
+
+#include "logentry.h"
+#include <QString>
+#include <QVector>
+
+// Pulls the entities an investigation pivots on out of a log message:
+// IPv4/IPv6 addresses, user names (sshd, PAM, sudo, su and session lines)
+// and ports ("port 22", iptables SPT=/DPT=, "10.0.0.1:443"). Each entity is
+// reported once per message, in the order first seen; IPv6 addresses are
+// lowercased, ports are 1-65535 without leading zeros.
+//
+// Every family is gated on a cheap substring check before its regexes run,
+// so the common line naming nothing costs a few scans. Safe to call from
+// several threads at once.
+class EntityExtractor {
+public:
+    static QVector<LogEntity> extract(const QString& message);
+    static void annotate(LogEntry& entry) { entry.entities = extract(entry.message); }
+};
+
+#endif // ENTITYEXTRACTOR_H
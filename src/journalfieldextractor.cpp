@@ -0,0 +1,112 @@
+#include "journalfieldextractor.h"
+#include <cstring>
+#include <systemd/sd-journal.h>
+
+int JournalFieldExtractor::fieldForName(const char* name, size_t len) {
+    struct FieldName {
+        const char* name;
+        int         field;
+    };
+    struct Bucket {
+        FieldName names[3];
+        int       count;
+    };
+
+    // Dispatch table bucketed by name length, so a lookup is one array index
+    // plus at most three memcmp() calls. The ~20 trusted fields we never
+    // display mostly fall into empty buckets and are rejected right away.
+    static constexpr size_t kMaxName = 17;  // strlen("SYSLOG_IDENTIFIER")
+    static const Bucket kBuckets[kMaxName + 1] = {
+        /*  0 */ {{}, 0}, /*  1 */ {{}, 0}, /*  2 */ {{}, 0}, /*  3 */ {{}, 0},
+        /*  4 */ {{{"_PID", Pid}, {"_EXE", Exe}}, 2},
+        /*  5 */ {{}, 0}, /*  6 */ {{}, 0},
+        /*  7 */ {{{"MESSAGE", Message}}, 1},
+        /*  8 */ {{{"PRIORITY", Priority}, {"_CMDLINE", Cmdline}, {"_BOOT_ID", BootId}}, 3},
+        /*  9 */ {{{"_HOSTNAME", Hostname}}, 1},
+        /* 10 */ {{{"SYSLOG_PID", SyslogPid}, {"MESSAGE_ID", MessageId}, {"_TRANSPORT", Transport}}, 3},
+        /* 11 */ {{}, 0}, /* 12 */ {{}, 0},
+        /* 13 */ {{{"_SYSTEMD_UNIT", SystemdUnit}}, 1},
+        /* 14 */ {{}, 0}, /* 15 */ {{}, 0}, /* 16 */ {{}, 0},
+        /* 17 */ {{{"SYSLOG_IDENTIFIER", SyslogIdentifier}}, 1},
+    };
+
+    if (len > kMaxName) return -1;
+    const Bucket& bucket = kBuckets[len];
+    for (int i = 0; i < bucket.count; ++i) {
+        if (memcmp(bucket.names[i].name, name, len) == 0) return bucket.names[i].field;
+    }
+    return -1;
+}
+
+void JournalFieldExtractor::begin() {
+    for (int i = 0; i < FieldCount; ++i) m_present[i] = false;
+    m_priority = 7;
+}
+
+void JournalFieldExtractor::feed(const void* data, size_t len) {
+    const char* p = static_cast<const char*>(data);
+    const char* eq = static_cast<const char*>(memchr(p, '=', len));
+    if (!eq) return;
+
+    const size_t nameLen = eq - p;
+    const int field = fieldForName(p, nameLen);
+    if (field < 0) return;
+
+    const char*  value    = eq + 1;
+    const size_t valueLen = len - nameLen - 1;
+    m_present[field] = true;
+
+    switch (field) {
+    case Priority:
+        // Single digit in practice; parse without building a string
+        m_priority = 0;
+        for (size_t i = 0; i < valueLen && value[i] >= '0' && value[i] <= '9'; ++i)
+            m_priority = m_priority * 10 + (value[i] - '0');
+        break;
+    case BootId:
+        // Only the 8-character prefix is ever displayed
+        m_values[field] = QString::fromLatin1(value, static_cast<int>(qMin<size_t>(valueLen, 8)));
+        break;
+    default:
+        m_values[field] = QString::fromUtf8(value, static_cast<int>(valueLen));
+        break;
+    }
+}
+
+int JournalFieldExtractor::finish(LogEntry& entry) {
+    auto take = [this](int field) -> QString {
+        return m_present[field] ? std::move(m_values[field]) : QString();
+    };
+
+    entry.message = take(Message);
+
+    // _SYSTEMD_UNIT wins over SYSLOG_IDENTIFIER regardless of field order
+    if (m_present[SystemdUnit])           entry.unit = take(SystemdUnit);
+    else if (m_present[SyslogIdentifier]) entry.unit = take(SyslogIdentifier);
+    else                                  entry.unit = "unknown";
+
+    if (m_present[Pid])            entry.pid = take(Pid);
+    else if (m_present[SyslogPid]) entry.pid = take(SyslogPid);
+
+    entry.exe       = take(Exe);
+    entry.cmdline   = take(Cmdline);
+    entry.hostname  = take(Hostname);
+    entry.bootId    = take(BootId);
+    entry.messageId = take(MessageId);
+    entry.transport = take(Transport);
+
+    return m_priority;
+}
+
+int JournalFieldExtractor::extract(sd_journal* j, LogEntry& entry) {
+    begin();
+
+    const void* data;
+    size_t len;
+    sd_journal_restart_data(j);
+    // _available_ skips fields that cannot be decompressed instead of failing
+    while (sd_journal_enumerate_available_data(j, &data, &len) > 0)
+        feed(data, len);
+
+    return finish(entry);
+}
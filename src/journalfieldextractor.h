@@ -0,0 +1,42 @@
+#ifndef JOURNALFIELDEXTRACTOR_H
+#define JOURNALFIELDEXTRACTOR_H
+
+#include "logentry.h"
+#include <QString>
+#include <cstddef>
+
+struct sd_journal;
+
+// Single-pass journal field extraction. Instead of one sd_journal_get_data()
+// lookup per field (each of which walks the entry's item list), the entry is
+// enumerated once and every "FIELD=value" blob is dispatched on its name
+// through a precomputed table. Only the value bytes after '=' are converted;
+// PRIORITY is parsed in place without building a string.
+class JournalFieldExtractor {
+public:
+    // Fills the journald-sourced fields of entry from the journal's current
+    // entry. Returns the PRIORITY value, or 7 (debug) when absent.
+    int extract(sd_journal* j, LogEntry& entry);
+
+    // Building blocks of extract(), exposed so the dispatch can be exercised
+    // and benchmarked without a journal: begin(), feed() every field blob,
+    // then finish() to resolve fallbacks and move the values into entry.
+    void begin();
+    void feed(const void* data, size_t len);
+    int  finish(LogEntry& entry);
+
+private:
+    enum Field {
+        Priority, Message, SystemdUnit, SyslogIdentifier, Pid, SyslogPid,
+        Exe, Cmdline, Hostname, BootId, MessageId, Transport,
+        FieldCount
+    };
+
+    static int fieldForName(const char* name, size_t len);
+
+    QString m_values[FieldCount];
+    bool    m_present[FieldCount] = {};
+    int     m_priority = 7;
+};
+
+#endif // JOURNALFIELDEXTRACTOR_H
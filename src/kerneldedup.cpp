@@ -0,0 +1,80 @@
+#include "kerneldedup.h"
+
+static constexpr quint64 kFnvOffset = 1469598103934665603ULL;
+static constexpr quint64 kFnvPrime  = 1099511628211ULL;
+
+KernelDedup::KernelDedup(qint64 toleranceUsec)
+    : m_toleranceUsec(qMax<qint64>(1, toleranceUsec)) {}
+
+quint64 KernelDedup::textKey(const QString& message) {
+    const QChar* p = message.constData();
+    const QChar* end = p + message.size();
+
+    while (p < end && p->isSpace()) ++p;
+
+    // Skip a "[   12.345678]" printk time prefix, if present
+    if (p < end && *p == QLatin1Char('[')) {
+        const QChar* q = p + 1;
+        while (q < end && *q == QLatin1Char(' ')) ++q;
+        const QChar* digits = q;
+        while (q < end && (q->isDigit() || *q == QLatin1Char('.'))) ++q;
+        if (q > digits && q < end && *q == QLatin1Char(']')) {
+            p = q + 1;
+            while (p < end && p->isSpace()) ++p;
+        }
+    }
+
+    // FNV-1a over UTF-16 units, whitespace runs folded into one space
+    quint64 hash = kFnvOffset;
+    bool pendingSpace = false;
+    for (; p < end; ++p) {
+        if (p->isSpace()) {
+            pendingSpace = true;
+            continue;
+        }
+        if (pendingSpace) {
+            hash = (hash ^ ' ') * kFnvPrime;
+            pendingSpace = false;
+        }
+        hash = (hash ^ p->unicode()) * kFnvPrime;
+    }
+    return hash;
+}
+
+quint64 KernelDedup::slotKey(quint64 text, qint64 bucket) const {
+    return (text ^ quint64(bucket)) * kFnvPrime;
+}
+
+void KernelDedup::add(const LogEntry& entry) {
+    if (entry.source != "dmesg" || entry.transport != "kernel") return;
+
+    const qint64 bucket = entry.timestampUsec / m_toleranceUsec;
+    Slot& slot = m_slots[slotKey(textKey(entry.message), bucket)];
+    slot.bucket = bucket;
+    ++slot.count;
+}
+
+bool KernelDedup::take(const LogEntry& entry) {
+    if (m_slots.isEmpty()) return false;
+    if (entry.source != "journald" || entry.transport != "kernel") return false;
+
+    const quint64 text = textKey(entry.message);
+    const qint64 usec = entry.kernelUsec > 0 ? entry.kernelUsec : entry.timestampUsec;
+    const qint64 bucket = usec / m_toleranceUsec;
+    // Same bucket first, then either neighbour
+    for (const qint64 probe : {bucket, bucket - 1, bucket + 1}) {
+        auto it = m_slots.find(slotKey(text, probe));
+        if (it == m_slots.end() || it->bucket != probe) continue;
+        if (--it->count == 0) m_slots.erase(it);
+        return true;
+    }
+    return false;
+}
+
+void KernelDedup::pruneBefore(qint64 usec) {
+    const qint64 cutoff = usec / m_toleranceUsec;
+    for (auto it = m_slots.begin(); it != m_slots.end();) {
+        if (it->bucket < cutoff) it = m_slots.erase(it);
+        else ++it;
+    }
+}
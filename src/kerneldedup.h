@@ -0,0 +1,56 @@
+#ifndef KERNELDEDUP_H
+#define KERNELDEDUP_H
+
+#include "logentry.h"
+#include <QHash>
+#include <QString>
+
+// journald ingests the kernel ring buffer (_TRANSPORT=kernel), so a scan
+// that also reads dmesg sees every kernel message twice. KernelDedup
+// recognises the pair: ring-buffer records are added, then journald kernel
+// records are looked up and consumed. Records are keyed on a hash of the
+// normalised message text and the time bucket it falls in; a lookup probes
+// the neighbouring buckets too, so copies up to one tolerance apart match.
+// Each added record matches at most one journald copy, so a message the
+// kernel really printed twice is still kept twice.
+//
+// journald copies are looked up by LogEntry::kernelUsec, the printk time on
+// the ring buffer's clock, since their realtime stamp is when journald read
+// the record and can trail it by far more than the tolerance. Without it
+// the realtime stamp is the fallback.
+//
+// The ring-buffer copy is the one kept: it carries the kmsg dictionary
+// (subsystem/device) and the record's own timestamp.
+class KernelDedup {
+public:
+    static constexpr qint64 kDefaultToleranceUsec = 5 * 1000000LL;
+
+    explicit KernelDedup(qint64 toleranceUsec = kDefaultToleranceUsec);
+
+    // Remembers a dmesg/kmsg kernel record; anything else is ignored
+    void add(const LogEntry& entry);
+    // True (and the match is consumed) when entry is a journald kernel
+    // record duplicating one added earlier. Other entries never match.
+    bool take(const LogEntry& entry);
+    // Forgets records from buckets entirely before usec
+    void pruneBefore(qint64 usec);
+    void clear() { m_slots.clear(); }
+    bool isEmpty() const { return m_slots.isEmpty(); }
+
+    // Hash of the message with surrounding whitespace trimmed, whitespace
+    // runs collapsed and a leading "[ secs.usecs]" printk stamp dropped
+    static quint64 textKey(const QString& message);
+
+private:
+    struct Slot {
+        qint64 bucket = 0;
+        int    count  = 0;
+    };
+
+    quint64 slotKey(quint64 text, qint64 bucket) const;
+
+    qint64                m_toleranceUsec;
+    QHash<quint64, Slot>  m_slots;
+};
+
+#endif // KERNELDEDUP_H
@@ -0,0 +1,163 @@
+#include "kmsgreader.h"
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Kernel limit for a formatted record including its dictionary
+// (CONSOLE_EXT_LOG_MAX); a smaller buffer makes read() fail with EINVAL.
+static constexpr size_t kMaxRecord = 8192;
+
+KmsgReader::~KmsgReader() {
+    close();
+}
+
+bool KmsgReader::open() {
+    if (m_fd >= 0) return true;
+
+    m_fd = ::open("/dev/kmsg", O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) return false;
+
+    // Record timestamps are monotonic; sample the offset to wall-clock time
+    // once rather than converting every record through QDateTime.
+    timespec realtime, monotonic;
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    clock_gettime(CLOCK_MONOTONIC, &monotonic);
+    m_bootTimeUsec = (qint64(realtime.tv_sec) - monotonic.tv_sec) * 1000000LL
+                   + (qint64(realtime.tv_nsec) - monotonic.tv_nsec) / 1000;
+    return true;
+}
+
+void KmsgReader::close() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void KmsgReader::setLastSequence(quint64 sequence) {
+    m_lastSequence = sequence;
+    m_hasSequence = true;
+}
+
+// The kernel escapes non-printable bytes and '\' as \xHH
+static QString unescapeKmsg(const char* begin, const char* end) {
+    if (!memchr(begin, '\\', end - begin)) return QString::fromUtf8(begin, end - begin);
+
+    auto hex = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    QByteArray out;
+    out.reserve(end - begin);
+    for (const char* p = begin; p < end; ++p) {
+        if (*p == '\\' && end - p >= 4 && p[1] == 'x' && hex(p[2]) >= 0 && hex(p[3]) >= 0) {
+            out.append(char(hex(p[2]) << 4 | hex(p[3])));
+            p += 3;
+        } else {
+            out.append(*p);
+        }
+    }
+    return QString::fromUtf8(out);
+}
+
+bool KmsgReader::parseRecord(const char* data, size_t len, KmsgRecord& record) {
+    const char* p = data;
+    const char* const end = data + len;
+
+    auto number = [&](quint64& value) {
+        if (p >= end || *p < '0' || *p > '9') return false;
+        value = 0;
+        while (p < end && *p >= '0' && *p <= '9') value = value * 10 + (*p++ - '0');
+        return true;
+    };
+
+    // Header: pri,seq,ts_usec,flags[,more fields];message
+    quint64 pri, seq, usec;
+    if (!number(pri) || p >= end || *p++ != ',') return false;
+    if (!number(seq) || p >= end || *p++ != ',') return false;
+    if (!number(usec)) return false;
+    const char* semi = static_cast<const char*>(memchr(p, ';', end - p));
+    if (!semi) return false;
+    p = semi + 1;
+
+    const char* nl = static_cast<const char*>(memchr(p, '\n', end - p));
+    const char* messageEnd = nl ? nl : end;
+
+    record.priority = int(pri & 7);
+    record.facility = int(pri >> 3);
+    record.sequence = seq;
+    record.monotonicUsec = qint64(usec);
+    record.message = unescapeKmsg(p, messageEnd);
+    record.subsystem.clear();
+    record.device.clear();
+
+    // Dictionary: one " KEY=value" continuation line per property
+    p = nl ? nl + 1 : end;
+    while (p < end) {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!lineEnd) lineEnd = end;
+        if (*p == ' ') {
+            const char* key = p + 1;
+            const char* eq = static_cast<const char*>(memchr(key, '=', lineEnd - key));
+            if (eq) {
+                const size_t keyLen = eq - key;
+                if (keyLen == 9 && memcmp(key, "SUBSYSTEM", 9) == 0)
+                    record.subsystem = unescapeKmsg(eq + 1, lineEnd);
+                else if (keyLen == 6 && memcmp(key, "DEVICE", 6) == 0)
+                    record.device = unescapeKmsg(eq + 1, lineEnd);
+            }
+        }
+        p = lineEnd + 1;
+    }
+    return true;
+}
+
+QVector<LogEntry> KmsgReader::readAvailable(const QDateTime& since, int maxPriority) {
+    QVector<LogEntry> entries;
+    if (m_fd < 0) return entries;
+
+    const qint64 sinceUsec = since.toMSecsSinceEpoch() * 1000;
+    char buffer[kMaxRecord];
+    KmsgRecord record;
+
+    for (;;) {
+        const ssize_t n = ::read(m_fd, buffer, sizeof(buffer));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            // Unread records were overwritten; the next read() continues at
+            // the oldest one still in the buffer, and the sequence gap says
+            // how many were lost
+            if (errno == EPIPE) continue;
+            break;  // EAGAIN: caught up
+        }
+        if (n == 0) break;
+        if (!parseRecord(buffer, size_t(n), record)) continue;
+
+        // Resuming after a reopen: everything up to the last sequence was
+        // already delivered
+        if (m_hasSequence && record.sequence <= m_lastSequence) continue;
+        if (m_hasSequence) m_dropped += record.sequence - m_lastSequence - 1;
+        m_lastSequence = record.sequence;
+        m_hasSequence = true;
+
+        if (record.facility != 0 || record.priority > maxPriority) continue;
+        const qint64 usec = m_bootTimeUsec + record.monotonicUsec;
+        if (usec < sinceUsec) continue;
+
+        LogEntry entry;
+        entry.source = "dmesg";
+        entry.timestampUsec = usec;
+        entry.priority = record.priority;
+        entry.unit = "kernel";
+        entry.message = std::move(record.message);
+        entry.transport = "kernel";
+        entry.subsystem = std::move(record.subsystem);
+        entry.device = std::move(record.device);
+        entries.append(std::move(entry));
+    }
+    return entries;
+}
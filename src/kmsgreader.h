@@ -0,0 +1,72 @@
+#ifndef KMSGREADER_H
+#define KMSGREADER_H
+
+#include "logentry.h"
+#include <QString>
+#include <QDateTime>
+#include <QVector>
+#include <cstddef>
+
+// One /dev/kmsg record, as parsed from the "pri,seq,ts_usec,flags;message"
+// header and the " KEY=value" dictionary lines that may follow it.
+struct KmsgRecord {
+    int     priority = 6;      // syslog level, 0-7
+    int     facility = 0;      // 0 = kernel, anything else was written by userspace
+    quint64 sequence = 0;
+    qint64  monotonicUsec = 0; // CLOCK_MONOTONIC at the time of logging
+    QString message;
+    QString subsystem;         // SUBSYSTEM= dictionary entry, if any
+    QString device;            // DEVICE= dictionary entry, if any
+};
+
+// Reads the kernel ring buffer straight from /dev/kmsg instead of spawning
+// dmesg. Every read() returns exactly one record; the fd is non-blocking, so
+// readAvailable() drains whatever is there and returns. Records carry a
+// sequence number, which is how a reader resumes without re-reading: an open
+// reader simply continues from its file position, and one that was reopened
+// skips everything up to lastSequence().
+class KmsgReader {
+public:
+    KmsgReader() = default;
+    ~KmsgReader();
+
+    KmsgReader(const KmsgReader&) = delete;
+    KmsgReader& operator=(const KmsgReader&) = delete;
+
+    // Fails when the device is missing or unreadable (dmesg_restrict without
+    // CAP_SYSLOG); callers then fall back to the dmesg subprocess.
+    bool open();
+    void close();
+    bool isOpen() const { return m_fd >= 0; }
+    // Pollable: becomes readable when new records are appended
+    int fd() const { return m_fd; }
+
+    // Returns the records appended since the last call (all of the buffer on
+    // the first call), oldest first, keeping those at or below maxPriority
+    // and not older than since. Entries carry source "dmesg" and the kernel
+    // dictionary; group and threat fields are left to the caller. Only the
+    // kernel's own records are returned: userspace writes to /dev/kmsg
+    // (facility other than kern) reach the journal under their own
+    // identifier, which journald parses and this reader does not.
+    QVector<LogEntry> readAvailable(const QDateTime& since, int maxPriority = 4);
+
+    quint64 lastSequence() const { return m_lastSequence; }
+    void    setLastSequence(quint64 sequence);
+
+    // Records the kernel overwrote before they were read, counted from gaps
+    // in the sequence numbers after the first record read (or the one set
+    // by setLastSequence())
+    quint64 droppedRecords() const { return m_dropped; }
+
+    // Parses one raw record. Public so tests can feed synthetic records.
+    static bool parseRecord(const char* data, size_t len, KmsgRecord& record);
+
+private:
+    int     m_fd = -1;
+    qint64  m_bootTimeUsec = 0;  // CLOCK_REALTIME - CLOCK_MONOTONIC, sampled at open()
+    quint64 m_lastSequence = 0;
+    bool    m_hasSequence = false;
+    quint64 m_dropped = 0;
+};
+
+#endif // KMSGREADER_H
@@ -0,0 +1,112 @@
+#include "literalmatcher.h"
+#include <QQueue>
+#include <algorithm>
+
+ushort LiteralMatcher::fold(ushort c) {
+    if (c >= 'A' && c <= 'Z') return c + ('a' - 'A');
+    if (c == 0x212A) return 'k';            // KELVIN SIGN
+    if (c == 0x017F) return 's';            // LATIN SMALL LETTER LONG S
+    return c;
+}
+
+bool LiteralMatcher::isAscii(const QString& literal) {
+    for (QChar c : literal) {
+        if (c.unicode() > 0x7F) return false;
+    }
+    return true;
+}
+
+int LiteralMatcher::add(const QString& literal) {
+    Q_ASSERT(!literal.isEmpty() && isAscii(literal));
+
+    QString folded = literal;
+    for (QChar& c : folded) c = QChar(fold(c.unicode()));
+
+    const int existing = m_literals.indexOf(folded);
+    if (existing >= 0) return existing;
+    m_literals.append(folded);
+    return m_literals.size() - 1;
+}
+
+void LiteralMatcher::build() {
+    m_class.fill(0);
+    m_classCount = 1;
+    for (const QString& literal : m_literals) {
+        for (QChar c : literal) {
+            quint8& cls = m_class[c.unicode()];
+            if (cls == 0) cls = quint8(m_classCount++);
+        }
+    }
+
+    // Trie, with -1 for missing edges
+    m_next = QVector<int>(m_classCount, -1);
+    QVector<QVector<int>> outputs(1);
+    for (int i = 0; i < m_literals.size(); ++i) {
+        int state = 0;
+        for (QChar c : m_literals[i]) {
+            const int slot = state * m_classCount + m_class[c.unicode()];
+            if (m_next[slot] < 0) {
+                m_next[slot] = outputs.size();
+                m_next.resize(m_next.size() + m_classCount);
+                std::fill(m_next.end() - m_classCount, m_next.end(), -1);
+                outputs.append({});
+            }
+            state = m_next[slot];
+        }
+        outputs[state].append(i);
+    }
+
+    // Breadth-first, so a state's failure target is complete before the
+    // state itself: missing edges take the failure target's transition and
+    // outputs are inherited along the failure link
+    QVector<int> fail(outputs.size(), 0);
+    QQueue<int> queue;
+    for (int cls = 0; cls < m_classCount; ++cls) {
+        int& target = m_next[cls];
+        if (target < 0) {
+            target = 0;
+        } else {
+            queue.enqueue(target);
+        }
+    }
+    while (!queue.isEmpty()) {
+        const int state = queue.dequeue();
+        outputs[state] += outputs[fail[state]];
+        for (int cls = 0; cls < m_classCount; ++cls) {
+            int& target = m_next[state * m_classCount + cls];
+            const int viaFail = m_next[fail[state] * m_classCount + cls];
+            if (target < 0) {
+                target = viaFail;
+            } else {
+                fail[target] = viaFail;
+                queue.enqueue(target);
+            }
+        }
+    }
+
+    m_outputBegin.clear();
+    m_outputs.clear();
+    for (const auto& list : outputs) {
+        m_outputBegin.append(m_outputs.size());
+        m_outputs += list;
+    }
+    m_outputBegin.append(m_outputs.size());
+}
+
+bool LiteralMatcher::scan(const QString& text, QVector<bool>& hits) const {
+    hits.fill(false, m_literals.size());
+    if (m_outputs.isEmpty()) return false;
+
+    bool found = false;
+    int state = 0;
+    for (QChar c : text) {
+        const ushort u = fold(c.unicode());
+        state = step(state, u < 0x80 ? m_class[u] : 0);
+        const int end = m_outputBegin[state + 1];
+        for (int i = m_outputBegin[state]; i < end; ++i) {
+            hits[m_outputs[i]] = true;
+            found = true;
+        }
+    }
+    return found;
+}
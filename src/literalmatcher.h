@@ -0,0 +1,49 @@
+#ifndef LITERALMATCHER_H
+#define LITERALMATCHER_H
+
+#include <QString>
+#include <QVector>
+#include <array>
+
+// Aho-Corasick automaton over a fixed set of ASCII literals, matched
+// case-insensitively. Literals are added, build() turns the trie into a
+// dense DFA (failure links folded into the transition table), and scan()
+// then finds every literal occurring in a text in one pass over it,
+// regardless of how many literals there are.
+//
+// Case folding is ASCII plus the two non-ASCII characters that fold to
+// ASCII letters (KELVIN SIGN and LATIN SMALL LETTER LONG S), so a hit set
+// is a superset of what a case-insensitive regex on the literal would
+// find. Characters that are not in any literal all share one input class.
+class LiteralMatcher {
+public:
+    // Returns the literal's index, reusing it for a literal (after case
+    // folding) added before. Literals must be non-empty and ASCII.
+    int add(const QString& literal);
+    void build();
+
+    int size() const { return m_literals.size(); }
+    const QString& literal(int index) const { return m_literals[index]; }
+
+    // Sets hits[i] for every literal i found in text; hits is resized to
+    // size() and cleared first. Returns whether anything was found.
+    bool scan(const QString& text, QVector<bool>& hits) const;
+
+    static bool isAscii(const QString& literal);
+
+private:
+    static ushort fold(ushort c);
+    int step(int state, int inputClass) const { return m_next[state * m_classCount + inputClass]; }
+
+    QVector<QString> m_literals;            // folded
+
+    // Built by build(). Character 0..127 map to an input class, class 0 is
+    // "not in any literal" (and every non-ASCII character).
+    std::array<quint8, 128> m_class{};
+    int m_classCount = 1;
+    QVector<int> m_next;                    // state * m_classCount + class
+    QVector<int> m_outputBegin;             // per state, into m_outputs
+    QVector<int> m_outputs;                 // literal indexes
+};
+
+#endif // LITERALMATCHER_H
@@ -1,13 +1,68 @@
 #include "logcollector.h"
 #include "threatdetector.h"
+#include "entityextractor.h"
+#include "parallelbatch.h"
+#include "templateminer.h"
+#include "journalfieldextractor.h"
+#include "kmsgreader.h"
+#include "dmesgparser.h"
+#include "logmerge.h"
 #include <unistd.h>  // ADD THIS LINE for getuid()
 #include <QProcess>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QRegularExpression>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSocketNotifier>
+#include <QThread>
+#include <QWaitCondition>
+#include <QTimer>
+#include <systemd/sd-id128.h>
 #include <systemd/sd-journal.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
 
-LogCollector::LogCollector(QObject* parent) : QObject(parent) {}
+// Push mode coalesces journal wakeups into one UI update per frame (~60 fps)
+static constexpr int kLiveCoalesceMs = 16;
+
+// A boot's first journald kernel record stamped this soon after boot means
+// journald drained the ring buffer from its start
+static constexpr qint64 kKernelBootCaptureUsec = 60 * 1000000LL;
+
+LogCollector::LogCollector(QObject* parent)
+    : QObject(parent), m_scanWorkers(qMax(1, QThread::idealThreadCount())) {}
+
+LogCollector::~LogCollector() {
+    closeLiveJournal();
+    closeLiveKmsg();
+}
+
+// Threat detection, entity extraction and template mining run on whole
+// collections (or streamed batches) once they are read, never inside the
+// journal or kmsg read loops, so readers do not wait on regex work. The
+// per-message work, tokenising included, shares one parallel pass so each
+// message is only pulled into cache once; clustering the tokens then runs
+// as a serial pass under a single lock of the shared miner rather than
+// contending on it per message.
+static void analyse(QVector<LogEntry>& entries) {
+    const auto detector = ThreatDetector::current();
+    QVector<QStringList> tokens(entries.size());
+    LogEntry* const first = entries.data();
+    QStringList* const tokenOut = tokens.data();
+    forEachParallel(first, first + entries.size(), ThreatDetector::kBatchChunk, 0,
+                    [&detector, first, tokenOut](LogEntry& entry) {
+                        detector->annotate(entry);
+                        EntityExtractor::annotate(entry);
+                        tokenOut[&entry - first] = TemplateMiner::tokenize(entry.message);
+                    });
+    TemplateMiner::shared().annotate(entries, tokens);
+}
+
+// Sink that collects streamed journal entries into a vector
+static std::function<void(LogEntry&&)> appendTo(QVector<LogEntry>& entries) {
+    return [&entries](LogEntry&& entry) { entries.append(std::move(entry)); };
+}
 
 QString LogCollector::groupForPriority(int priority) {
     if (priority <= 2) return "critical";
@@ -16,185 +71,890 @@ QString LogCollector::groupForPriority(int priority) {
     return "";
 }
 
+void LogCollector::setUnitFilter(const QStringList& units) {
+    m_unitFilter = units;
+    resetLiveCursor();
+}
+
+void LogCollector::setHostFilter(const QStringList& hosts) {
+    m_hostFilter = hosts;
+    resetLiveCursor();
+}
+
+void LogCollector::setBootFilter(const QString& bootId) {
+    m_bootFilter = bootId;
+    resetLiveCursor();
+}
+
+// Full id of the running boot, or empty if it cannot be read
+static QString currentBootId() {
+    sd_id128_t boot;
+    if (sd_id128_get_boot(&boot) < 0) return QString();
+    char bootId[SD_ID128_STRING_MAX];
+    sd_id128_to_string(boot, bootId);
+    return QString::fromLatin1(bootId);
+}
+
+QVector<JournalBoot> LogCollector::bootIndex() const {
+    QVector<JournalBoot> boots;
+    sd_journal* j = nullptr;
+    if (sd_journal_open(&j, SD_JOURNAL_LOCAL_ONLY) < 0) return boots;
+
+    // The unique values come from the field's hash table, not an entry walk
+    QList<QByteArray> ids;
+    if (sd_journal_query_unique(j, "_BOOT_ID") >= 0) {
+        const void* data = nullptr;
+        size_t len = 0;
+        SD_JOURNAL_FOREACH_UNIQUE(j, data, len) {
+            const QByteArray field(static_cast<const char*>(data), int(len));
+            ids << field.mid(field.indexOf('=') + 1);
+        }
+    }
+
+    // Per boot, one seek to each end of its entry array
+    for (const QByteArray& id : ids) {
+        const QByteArray match = "_BOOT_ID=" + id;
+        sd_journal_flush_matches(j);
+        sd_journal_add_match(j, match.constData(), match.size());
+
+        JournalBoot boot;
+        boot.bootId = QString::fromLatin1(id);
+        uint64_t usec;
+        sd_journal_seek_head(j);
+        if (sd_journal_next(j) > 0 && sd_journal_get_realtime_usec(j, &usec) >= 0)
+            boot.firstUsec = qint64(usec);
+        sd_journal_seek_tail(j);
+        if (sd_journal_previous(j) > 0 && sd_journal_get_realtime_usec(j, &usec) >= 0)
+            boot.lastUsec = qint64(usec);
+        // Listed by the field table but with no entries left (vacuumed)
+        if (boot.lastUsec > 0) boots.append(boot);
+    }
+    sd_journal_close(j);
+
+    std::sort(boots.begin(), boots.end(), [](const JournalBoot& a, const JournalBoot& b) {
+        return a.firstUsec > b.firstUsec;
+    });
+    return boots;
+}
+
+void LogCollector::addJournalMatches(sd_journal* j) const {
+    // Matches on the same field are OR'ed, different fields AND'ed
+    for (int prio = 0; prio <= 4; ++prio) {
+        const QByteArray match = "PRIORITY=" + QByteArray::number(prio);
+        sd_journal_add_match(j, match.constData(), match.size());
+    }
+    for (const QString& unit : m_unitFilter) {
+        const QByteArray match = "_SYSTEMD_UNIT=" + unit.toUtf8();
+        sd_journal_add_match(j, match.constData(), match.size());
+    }
+    for (const QString& host : m_hostFilter) {
+        const QByteArray match = "_HOSTNAME=" + host.toUtf8();
+        sd_journal_add_match(j, match.constData(), match.size());
+    }
+    if (!m_bootFilter.isEmpty()) {
+        const QByteArray match = "_BOOT_ID=" + m_bootFilter.toLatin1();
+        sd_journal_add_match(j, match.constData(), match.size());
+    }
+}
+
+void LogCollector::setScanWorkers(int workers) {
+    m_scanWorkers = qBound(1, workers, 256);
+}
+
 QVector<LogEntry> LogCollector::collectAll(int lookbackDays) {
+    m_activeScan = m_scanGeneration.load();
     QDateTime since = QDateTime::currentDateTimeUtc().addDays(-lookbackDays);
-    QVector<LogEntry> entries = collectJournald(since);
-    entries.append(collectDmesg(since));
+    QVector<LogEntry> journal;
+    if (m_scanWorkers > 1) streamJournaldSharded(since, 10000, m_scanWorkers, appendTo(journal));
+    else journal = collectJournald(since);
+    m_lastDmesgSkipped = canSkipDmesg(since);
+    QVector<LogEntry> kernel = m_lastDmesgSkipped ? QVector<LogEntry>() : collectDmesg(since);
     
-    // Sort by timestamp descending
-    std::sort(entries.begin(), entries.end(), [](const LogEntry& a, const LogEntry& b) {
-        return a.timestamp > b.timestamp;
-    });
+    if (isScanCancelled()) {
+        emit collectionCancelled(m_activeScan);
+        return {};
+    }
+    
+    // The journal walk is already newest-first; the kernel log is in ring
+    // order (oldest-first) and just needs flipping before the merge.
+    makeNewestFirst(kernel);
+    m_lastKernelDuplicates = dropKernelDuplicates(journal, kernel);
+    std::vector<QVector<LogEntry>> runs;
+    runs.push_back(std::move(journal));
+    runs.push_back(std::move(kernel));
+    QVector<LogEntry> entries = mergeNewestFirst(std::move(runs));
+    analyse(entries);
+    CorrelationEngine().process(entries);
     
     emit collectionComplete(entries.size());
     return entries;
 }
 
+void LogCollector::collectAllStreaming(int lookbackDays, int batchSize) {
+    streamScan(lookbackDays, batchSize, m_scanGeneration.load());
+}
+
+quint64 LogCollector::requestScan(int lookbackDays, int batchSize) {
+    // Bumping the generation cancels whatever is running right now
+    const quint64 scanId = ++m_scanGeneration;
+    QMetaObject::invokeMethod(this, [this, lookbackDays, batchSize, scanId]() {
+        // Superseded again while it sat in the queue
+        if (m_scanGeneration.load() != scanId) {
+            emit collectionCancelled(scanId);
+            return;
+        }
+        streamScan(lookbackDays, batchSize, scanId);
+    }, Qt::QueuedConnection);
+    return scanId;
+}
+
+void LogCollector::streamScan(int lookbackDays, int batchSize, quint64 scanId) {
+    m_activeScan = scanId;
+    const QDateTime windowStart = QDateTime::currentDateTimeUtc().addDays(-lookbackDays);
+    const qint64 windowStartUsec = windowStart.toMSecsSinceEpoch() * 1000;
+    
+    // With a usable checkpoint only what was written after it is read; the
+    // rest of the window is already in the caller's store
+    const ScanCheckpoint resume = m_resumeCheckpoint;
+    m_resumeCheckpoint = ScanCheckpoint();
+    const qint64 resumeUsec = checkpointUsec(resume, windowStartUsec);
+    m_lastScanResumed = resumeUsec > 0;
+    emit scanStarted(scanId, m_lastScanResumed);
+    const QDateTime since = m_lastScanResumed
+        ? QDateTime::fromMSecsSinceEpoch(resumeUsec / 1000, Qt::UTC) : windowStart;
+    const qint64 sinceUsec = since.toMSecsSinceEpoch() * 1000;
+    const qint64 windowUsec = qMax<qint64>(1, QDateTime::currentMSecsSinceEpoch() * 1000 - sinceUsec);
+    constexpr int kProgressSteps = 1000;
+    int progress = 0;
+    emit collectionProgress(0, kProgressSteps);
+    
+    // The kernel ring buffer is small, so dmesg is read up front and merged
+    // into the journal stream by timestamp as the journal is walked. The
+    // journald copies of its records are dropped as they stream past.
+    m_lastDmesgSkipped = canSkipDmesg(since);
+    m_lastKernelDuplicates = 0;
+    const QString bootId = currentBootId();
+    // kmsg sequence numbers restart with every boot
+    quint64 kmsgSequence = (m_lastScanResumed && resume.kmsgBootId == bootId) ? resume.kmsgSequence : 0;
+    quint64 kmsgLost = 0;
+    QVector<LogEntry> dmesg = m_lastDmesgSkipped ? QVector<LogEntry>()
+                                                 : collectDmesg(since, &kmsgSequence, &kmsgLost);
+    makeNewestFirst(dmesg);
+    KernelDedup kernelSeen;
+    for (const auto& entry : dmesg) kernelSeen.add(entry);
+    int dmesgPos = 0;
+    
+    QVector<LogEntry> batch;
+    batch.reserve(batchSize);
+    int delivered = 0;
+    // Fed batch by batch, i.e. newest-first across the whole scan
+    CorrelationEngine correlation;
+    auto push = [&](LogEntry&& entry) {
+        // The stream is newest-first, so the distance from now to the entry
+        // is how far through the window the scan has got
+        const int step = int((windowUsec - (entry.timestampUsec - sinceUsec))
+                             * kProgressSteps / windowUsec);
+        if (step > progress) {
+            progress = qMin(step, kProgressSteps);
+            emit collectionProgress(progress, kProgressSteps);
+        }
+        
+        batch.append(std::move(entry));
+        if (batch.size() >= batchSize) {
+            // The shard readers keep going on their own threads meanwhile
+            analyse(batch);
+            correlation.process(batch);
+            delivered += batch.size();
+            emit batchReady(batch, scanId);
+            batch.clear();
+            batch.reserve(batchSize);
+        }
+    };
+    QString newestCursor;
+    qint64 oldestJournalUsec = 0;
+    const EntrySink sink = [&](LogEntry&& entry) {
+        if (isScanCancelled()) return;
+        if (newestCursor.isEmpty()) newestCursor = entry.cursor;
+        oldestJournalUsec = oldestJournalUsec ? qMin(oldestJournalUsec, entry.timestampUsec)
+                                              : entry.timestampUsec;
+        if (kernelSeen.take(entry)) {
+            ++m_lastKernelDuplicates;
+            return;
+        }
+        while (dmesgPos < dmesg.size() && dmesg[dmesgPos].timestampUsec > entry.timestampUsec)
+            push(std::move(dmesg[dmesgPos++]));
+        push(std::move(entry));
+    };
+    
+    // Even a single reader goes through the sharded handoff, which keeps
+    // the journal walk off this thread while it analyses batches
+    if (!isScanCancelled()) streamJournaldSharded(since, 10000, m_scanWorkers, sink);
+    
+    if (isScanCancelled()) {
+        m_lastJournalStats.cancelled = true;
+        emit collectionCancelled(scanId);
+        return;
+    }
+    m_lastJournalStats.kernelRecordsLost = qint64(kmsgLost);
+    
+    while (dmesgPos < dmesg.size()) push(std::move(dmesg[dmesgPos++]));
+    if (!batch.isEmpty()) {
+        analyse(batch);
+        correlation.process(batch);
+        delivered += batch.size();
+        emit batchReady(batch, scanId);
+    }
+    
+    // Nothing new since a resumed checkpoint leaves its cursor in place
+    m_lastCheckpoint = ScanCheckpoint();
+    m_lastCheckpoint.journalCursor = newestCursor.isEmpty() && m_lastScanResumed
+        ? resume.journalCursor : newestCursor;
+    m_lastCheckpoint.journalScope = journalScope();
+    m_lastCheckpoint.coveredFromUsec = m_lastScanResumed ? resume.coveredFromUsec : windowStartUsec;
+    // Hitting the entry cap left a gap between since and the oldest entry
+    // read, so the coverage stops there; the next scan whose window reaches
+    // past it reads the whole window again
+    if (m_lastJournalStats.truncated)
+        m_lastCheckpoint.coveredFromUsec = qMax(oldestJournalUsec, sinceUsec);
+    if (kmsgSequence > 0) {
+        m_lastCheckpoint.kmsgBootId = bootId;
+        m_lastCheckpoint.kmsgSequence = kmsgSequence;
+    }
+    
+    emit collectionProgress(kProgressSteps, kProgressSteps);
+    emit collectionComplete(delivered);
+}
+
+QString LogCollector::journalScope() const {
+    return QString("units=%1;hosts=%2;boot=%3")
+        .arg(m_unitFilter.join(','), m_hostFilter.join(','), m_bootFilter);
+}
+
+qint64 LogCollector::checkpointUsec(const ScanCheckpoint& checkpoint, qint64 windowStartUsec) const {
+    if (checkpoint.journalCursor.isEmpty()) return 0;
+    // Taken under other filters, the store lacks entries they now admit
+    if (checkpoint.journalScope != journalScope()) return 0;
+    // The window reaches further back than the scans behind it did
+    if (checkpoint.coveredFromUsec > windowStartUsec) return 0;
+
+    sd_journal* j = nullptr;
+    if (sd_journal_open(&j, SD_JOURNAL_LOCAL_ONLY) < 0) return 0;
+    const QByteArray cursor = checkpoint.journalCursor.toUtf8();
+    uint64_t usec = 0;
+    // The cursor's entry must still exist; vacuumed or rotated away, the
+    // position is unknown and the whole window is read again
+    const bool found = sd_journal_seek_cursor(j, cursor.constData()) >= 0
+        && sd_journal_next(j) > 0
+        && sd_journal_test_cursor(j, cursor.constData()) > 0
+        && sd_journal_get_realtime_usec(j, &usec) >= 0;
+    sd_journal_close(j);
+
+    // Older than the window: a plain window scan reads less
+    return found && qint64(usec) > windowStartUsec ? qint64(usec) : 0;
+}
+
 QVector<LogEntry> LogCollector::collectLive(int windowMinutes) {
+    m_activeScan = m_scanGeneration.load();
     QDateTime since = QDateTime::currentDateTimeUtc().addSecs(-windowMinutes * 60);
-    QVector<LogEntry> entries = collectJournald(since, 5000);
-    entries.append(collectDmesg(since));
-    
-    std::sort(entries.begin(), entries.end(), [](const LogEntry& a, const LogEntry& b) {
-        return a.timestamp > b.timestamp;
-    });
+    m_lastDmesgSkipped = canSkipDmesg(since);
+    QVector<LogEntry> kernel = m_lastDmesgSkipped ? QVector<LogEntry>() : collectDmesg(since);
+    makeNewestFirst(kernel);
+    QVector<LogEntry> journal = collectJournald(since, 5000);
+    m_lastKernelDuplicates = dropKernelDuplicates(journal, kernel);
+    std::vector<QVector<LogEntry>> runs;
+    runs.push_back(std::move(journal));
+    runs.push_back(std::move(kernel));
+    QVector<LogEntry> entries = mergeNewestFirst(std::move(runs));
+    analyse(entries);
+    CorrelationEngine().process(entries);
     
     emit collectionComplete(entries.size());
     return entries;
 }
 
-QVector<LogEntry> LogCollector::collectJournald(const QDateTime& since, int maxEntries) {
-    QVector<LogEntry> entries;
+bool LogCollector::readJournalEntry(sd_journal* j, LogEntry& entry) {
+    entry.source = "journald";
     
-     qDebug() << "collectJournald called, since:" << since;
+    // Timestamp
+    uint64_t usec;
+    if (sd_journal_get_realtime_usec(j, &usec) >= 0) {
+        entry.timestampUsec = qint64(usec);
+    } else {
+        entry.timestampUsec = QDateTime::currentMSecsSinceEpoch() * 1000;
+    }
+    
+    // All remaining fields in a single pass over the entry's data
+    JournalFieldExtractor extractor;
+    entry.priority = extractor.extract(j, entry);
+    entry.group = groupForPriority(entry.priority);
+    
+    if (entry.group.isEmpty()) return false; // Skip if not 0-4
 
-    sd_journal* j = nullptr;
-    int ret = sd_journal_open(&j, SD_JOURNAL_LOCAL_ONLY);
-    qDebug() << "sd_journal_open returned:" << ret;
+    // The realtime stamp of a kernel record is when journald read it, which
+    // lags the printk when journald is busy. Boot time (realtime less
+    // monotonic at receipt) plus the record's own monotonic stamp puts it
+    // back on the clock /dev/kmsg records use.
+    if (entry.transport == "kernel") {
+        const void* data = nullptr;
+        size_t len = 0;
+        uint64_t monotonicUsec = 0;
+        sd_id128_t boot;
+        if (sd_journal_get_data(j, "_SOURCE_MONOTONIC_TIMESTAMP", &data, &len) >= 0
+            && sd_journal_get_monotonic_usec(j, &monotonicUsec, &boot) >= 0) {
+            const QByteArray field(static_cast<const char*>(data), int(len));
+            const qint64 sourceUsec = field.mid(field.indexOf('=') + 1).toLongLong();
+            entry.kernelUsec = entry.timestampUsec - qint64(monotonicUsec) + sourceUsec;
+        }
+    }
     
-    if (ret < 0) {
-        qDebug() << "sd_journal_open FAILED.";
-        emit collectionError("Failed to open systemd journal");
-        return entries;
+    // Cursor
+    char* cursor;
+    if (sd_journal_get_cursor(j, &cursor) >= 0) {
+        entry.cursor = QString::fromUtf8(cursor);
+        free(cursor);
     }
-    qDebug() << "Journal opened successfully";
-     // Filter: priority 0-4 (emergency through warning)
-    qDebug() << "Skipping priority filters - will filter in loop";
-    // Seek to timestamp
-    sd_journal_seek_realtime_usec(j, since.toSecsSinceEpoch() * 1000000ULL);
-        qDebug() << "Starting to read entries, maxEntries:" << maxEntries;
     
-    // Read entries (newest first via SD_JOURNAL_FOREACH_BACKWARDS would require seeking to end)
-    // For simplicity, read forward and reverse in memory
-    QVector<LogEntry> tempEntries;
-    int loopCount = 0;
+    return true;
+}
+
+void LogCollector::readJournalBackward(sd_journal* j, quint64 sinceUsec, quint64 untilUsec,
+                                       int maxEntries, const EntrySink& sink,
+                                       JournalScanStats& stats, QString* newestCursor) {
+    stats = JournalScanStats();
     
-    while (sd_journal_next(j) > 0 && tempEntries.size() < maxEntries) {
-        loopCount++;
-        LogEntry entry;
-        entry.source = "journald";
+    while (stats.entriesKept < maxEntries && sd_journal_previous(j) > 0) {
+        if (isScanCancelled()) {
+            stats.cancelled = true;
+            return;
+        }
+        ++stats.entriesTouched;
         
-        // Timestamp
+        // Walking backwards, the first entry before since ends the window
         uint64_t usec;
         if (sd_journal_get_realtime_usec(j, &usec) >= 0) {
-            entry.timestamp = QDateTime::fromSecsSinceEpoch(usec / 1000000, Qt::UTC);
-        } else {
-            entry.timestamp = QDateTime::currentDateTimeUtc();
+            if (usec < sinceUsec) break;
+            // Belongs to the next-newer shard
+            if (untilUsec && usec >= untilUsec) continue;
         }
         
-        // Skip if before since
-        if (entry.timestamp < since) continue;
-        
-        // Priority
-        const char* priority_str;
-        size_t len;
-        int prio = 7;
-        if (sd_journal_get_data(j, "PRIORITY", (const void**)&priority_str, &len) >= 0) {
-            QString prioVal = QString::fromUtf8(priority_str, len).section('=', 1);
-            prio = prioVal.toInt();
+        if (newestCursor && newestCursor->isEmpty()) {
+            char* cursor;
+            if (sd_journal_get_cursor(j, &cursor) >= 0) {
+                *newestCursor = QString::fromUtf8(cursor);
+                free(cursor);
+            }
         }
-        entry.priority = prio;
-        entry.group = groupForPriority(prio);
         
-        if (entry.group.isEmpty()) continue; // Skip if not 0-4
+        LogEntry entry;
+        if (!readJournalEntry(j, entry)) continue;
         
-        // Message
-        const char* msg;
-        if (sd_journal_get_data(j, "MESSAGE", (const void**)&msg, &len) >= 0) {
-            entry.message = QString::fromUtf8(msg, len).section('=', 1);
-        }
+        sink(std::move(entry));
+        ++stats.entriesKept;
+    }
+    
+    // Stopping on the cap while in-window entries remain means the window was
+    // cut short — the dropped entries are the oldest ones.
+    if (stats.entriesKept >= maxEntries && sd_journal_previous(j) > 0) {
+        uint64_t usec;
+        stats.truncated =
+            sd_journal_get_realtime_usec(j, &usec) >= 0 && usec >= sinceUsec;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Incremental live collection
+// ---------------------------------------------------------------------------
+
+bool LogCollector::openLiveJournal() {
+    if (m_liveJournal) return true;
+    
+    if (sd_journal_open(&m_liveJournal, SD_JOURNAL_LOCAL_ONLY) < 0) {
+        m_liveJournal = nullptr;
+        emit collectionError("Failed to open systemd journal");
+        return false;
+    }
+    addJournalMatches(m_liveJournal);
+    // Allocating the fd sets up inotify so sd_journal_process() can notice
+    // rotated and newly created journal files between polls.
+    sd_journal_get_fd(m_liveJournal);
+    return true;
+}
+
+void LogCollector::closeLiveJournal() {
+    // The notifier watches the journal's inotify fd, which dies with it
+    delete m_liveNotifier;
+    m_liveNotifier = nullptr;
+    if (m_liveJournal) {
+        sd_journal_close(m_liveJournal);
+        m_liveJournal = nullptr;
+    }
+}
+
+bool LogCollector::openLiveKmsg() {
+    if (!m_liveKmsg) m_liveKmsg = new KmsgReader();
+    return m_liveKmsg->open();
+}
+
+void LogCollector::closeLiveKmsg() {
+    delete m_liveKmsgNotifier;
+    m_liveKmsgNotifier = nullptr;
+    delete m_liveKmsg;
+    m_liveKmsg = nullptr;
+}
+
+void LogCollector::resetLiveCursor() {
+    closeLiveJournal();
+    closeLiveKmsg();
+    m_liveCursor.clear();
+    m_liveDmesgHighWater = 0;
+    m_liveDmesgSkipped = false;
+    m_liveKernelSeen.clear();
+    m_liveCorrelation.clear();
+    m_livePrimed = false;
+    m_liveInvalidated = false;
+}
+
+QVector<LogEntry> LogCollector::collectLiveIncremental(int windowMinutes) {
+    m_activeScan = m_scanGeneration.load();
+    const QDateTime since = QDateTime::currentDateTimeUtc().addSecs(-windowMinutes * 60);
+    const qint64 sinceUsec = since.toMSecsSinceEpoch() * 1000;
+    QVector<LogEntry> entries;
+    
+    if (!openLiveJournal()) return entries;
+    
+    const bool priming = !m_livePrimed;
+    if (priming) {
+        // First poll: newest-first from the tail so the cap keeps the most
+        // recent part of the window, then park the read position on the
+        // newest entry so the next sd_journal_next() yields only new ones.
+        sd_journal_seek_tail(m_liveJournal);
+        QString newestCursor;
+        readJournalBackward(m_liveJournal, quint64(sinceUsec), 0, 5000,
+                            appendTo(entries), m_lastJournalStats, &newestCursor);
         
-        // Unit
-        const char* unit;
-        if (sd_journal_get_data(j, "_SYSTEMD_UNIT", (const void**)&unit, &len) >= 0) {
-            entry.unit = QString::fromUtf8(unit, len).section('=', 1);
-        } else if (sd_journal_get_data(j, "SYSLOG_IDENTIFIER", (const void**)&unit, &len) >= 0) {
-            entry.unit = QString::fromUtf8(unit, len).section('=', 1);
+        if (newestCursor.isEmpty()) {
+            sd_journal_seek_tail(m_liveJournal);
         } else {
-            entry.unit = "unknown";
-        }
-        
-        // PID
-        const char* pid;
-        if (sd_journal_get_data(j, "_PID", (const void**)&pid, &len) >= 0) {
-            entry.pid = QString::fromUtf8(pid, len).section('=', 1);
-        } else if (sd_journal_get_data(j, "SYSLOG_PID", (const void**)&pid, &len) >= 0) {
-            entry.pid = QString::fromUtf8(pid, len).section('=', 1);
+            m_liveCursor = newestCursor;
+            sd_journal_seek_cursor(m_liveJournal, newestCursor.toUtf8().constData());
+            sd_journal_next(m_liveJournal);
         }
-        
-        // Executable
-        const char* exe;
-        if (sd_journal_get_data(j, "_EXE", (const void**)&exe, &len) >= 0) {
-            entry.exe = QString::fromUtf8(exe, len).section('=', 1);
+        m_liveInvalidated = false;
+        m_liveNewestEventUsec = 0;
+    } else {
+        if ((sd_journal_process(m_liveJournal) == SD_JOURNAL_INVALIDATE || m_liveInvalidated)
+            && !m_liveCursor.isEmpty()) {
+            // Journal files were added or removed; the read position is no
+            // longer trustworthy, so re-anchor on the last delivered cursor.
+            // The first sd_journal_next() below lands on that entry again.
+            if (sd_journal_seek_cursor(m_liveJournal, m_liveCursor.toUtf8().constData()) >= 0
+                && sd_journal_next(m_liveJournal) > 0
+                && sd_journal_test_cursor(m_liveJournal, m_liveCursor.toUtf8().constData()) <= 0) {
+                // Cursor entry vanished (vacuumed) — step back so nothing after it is skipped
+                sd_journal_previous(m_liveJournal);
+            }
         }
         
-        // Cmdline
-        const char* cmdline;
-        if (sd_journal_get_data(j, "_CMDLINE", (const void**)&cmdline, &len) >= 0) {
-            entry.cmdline = QString::fromUtf8(cmdline, len).section('=', 1);
-        }
+        m_liveInvalidated = false;
+        m_liveNewestEventUsec = 0;
+        m_lastJournalStats = JournalScanStats();
         
-        // Hostname
-        const char* host;
-        if (sd_journal_get_data(j, "_HOSTNAME", (const void**)&host, &len) >= 0) {
-            entry.hostname = QString::fromUtf8(host, len).section('=', 1);
+        // The handle stays positioned on the last entry read, so sd_journal_next()
+        // only yields entries appended since the previous poll. The cap is
+        // checked first: advancing past an entry that is then not read would
+        // lose it for good.
+        while (entries.size() < 5000 && sd_journal_next(m_liveJournal) > 0) {
+            ++m_lastJournalStats.entriesTouched;
+            LogEntry entry;
+            if (!readJournalEntry(m_liveJournal, entry)) continue;
+            m_liveCursor = entry.cursor;
+            if (entry.timestampUsec < sinceUsec) continue;
+            
+            uint64_t usec;
+            if (sd_journal_get_realtime_usec(m_liveJournal, &usec) >= 0)
+                m_liveNewestEventUsec = qMax<qint64>(m_liveNewestEventUsec, usec);
+            
+            entries.append(entry);
         }
-        
-        // Boot ID
-        const char* boot;
-        if (sd_journal_get_data(j, "_BOOT_ID", (const void**)&boot, &len) >= 0) {
-            QString bootId = QString::fromUtf8(boot, len).section('=', 1);
-            entry.bootId = bootId.left(8);
+        m_lastJournalStats.entriesKept = entries.size();
+        // Deltas are read oldest-first; the consumer wants newest-first
+        std::reverse(entries.begin(), entries.end());
+    }
+    
+    // Whether the ring buffer is needed at all is settled once per priming
+    if (priming) m_liveDmesgSkipped = canSkipDmesg(since);
+    m_lastDmesgSkipped = m_liveDmesgSkipped;
+    
+    QVector<LogEntry> kernel;
+    if (m_liveDmesgSkipped) {
+        // journald delivers the kernel records
+    } else if (openLiveKmsg()) {
+        // The kmsg fd stays open, so each read continues after the last
+        // record delivered
+        kernel = finishKernelEntries(m_liveKmsg->readAvailable(since));
+    } else if (priming || !m_liveWatching || !m_liveDmesgLastRun.isValid()
+               || m_liveDmesgLastRun.hasExpired(m_liveDmesgIntervalMs)) {
+        // Push mode wakes on every journal append; forking dmesg and
+        // re-parsing the whole ring buffer that often would cost more than
+        // the records are worth, so it keeps to the poll cadence
+        if (m_liveWatching) m_liveDmesgLastRun.start();
+        // The dmesg subprocess has no cursor; deliver only what is newer
+        // than the last poll
+        const QDateTime dmesgSince = m_liveDmesgHighWater > sinceUsec
+            ? QDateTime::fromMSecsSinceEpoch(m_liveDmesgHighWater / 1000, Qt::UTC) : since;
+        for (const auto& entry : collectDmesgProcess(dmesgSince)) {
+            // Collector diagnostics are only reported once per priming poll
+            if (entry.transport == "collector" && !priming) continue;
+            if (m_liveDmesgHighWater > 0 && entry.timestampUsec <= m_liveDmesgHighWater) continue;
+            kernel.append(entry);
         }
-        
-        // Message ID
-        const char* msgid;
-        if (sd_journal_get_data(j, "MESSAGE_ID", (const void**)&msgid, &len) >= 0) {
-            entry.messageId = QString::fromUtf8(msgid, len).section('=', 1);
+        for (const auto& entry : kernel) {
+            if (entry.transport != "collector" && entry.timestampUsec > m_liveDmesgHighWater)
+                m_liveDmesgHighWater = entry.timestampUsec;
         }
-        
-        // Transport
-        const char* transport;
-        if (sd_journal_get_data(j, "_TRANSPORT", (const void**)&transport, &len) >= 0) {
-            entry.transport = QString::fromUtf8(transport, len).section('=', 1);
+    }
+    
+    // journald reads the ring buffer after we can, so its copy of a kernel
+    // record arrives in the same poll as ours or a later one; keep the
+    // window's records around to recognise it
+    m_liveKernelSeen.pruneBefore(sinceUsec);
+    for (const auto& entry : kernel) m_liveKernelSeen.add(entry);
+    const auto duplicate = std::remove_if(entries.begin(), entries.end(),
+        [this](const LogEntry& entry) { return m_liveKernelSeen.take(entry); });
+    m_lastKernelDuplicates = int(entries.end() - duplicate);
+    entries.erase(duplicate, entries.end());
+    
+    makeNewestFirst(kernel);
+    std::vector<QVector<LogEntry>> runs;
+    runs.push_back(std::move(entries));
+    runs.push_back(std::move(kernel));
+    entries = mergeNewestFirst(std::move(runs));
+    analyse(entries);
+    // Polls move forward in time; each one is newest-first
+    m_liveCorrelation.process(entries, CorrelationEngine::Order::Reversed);
+    
+    m_livePrimed = true;
+    emit collectionComplete(entries.size());
+    return entries;
+}
+
+// ---------------------------------------------------------------------------
+// Push-driven live mode
+// ---------------------------------------------------------------------------
+
+void LogCollector::startLiveWatch(int windowMinutes, int dmesgIntervalMs) {
+    m_liveWindowMinutes = windowMinutes;
+    m_liveDmesgIntervalMs = dmesgIntervalMs;
+    m_liveWatching = true;
+
+    if (!m_liveCoalesceTimer) {
+        m_liveCoalesceTimer = new QTimer(this);
+        m_liveCoalesceTimer->setSingleShot(true);
+        m_liveCoalesceTimer->setInterval(kLiveCoalesceMs);
+        connect(m_liveCoalesceTimer, &QTimer::timeout, this, &LogCollector::deliverLiveDelta);
+    }
+
+    // Priming delivery (or the next delta, if already primed)
+    deliverLiveDelta();
+}
+
+void LogCollector::stopLiveWatch() {
+    m_liveWatching = false;
+    if (m_liveCoalesceTimer) m_liveCoalesceTimer->stop();
+    if (m_liveNotifier) m_liveNotifier->setEnabled(false);
+    if (m_liveKmsgNotifier) m_liveKmsgNotifier->setEnabled(false);
+}
+
+void LogCollector::armLiveNotifier() {
+    // Kernel records wake us directly instead of waiting for journald to
+    // pick them up
+    if (m_liveKmsg && m_liveKmsg->isOpen()) {
+        if (!m_liveKmsgNotifier) {
+            m_liveKmsgNotifier = new QSocketNotifier(m_liveKmsg->fd(), QSocketNotifier::Read, this);
+            connect(m_liveKmsgNotifier, &QSocketNotifier::activated, this, &LogCollector::onKmsgActivity);
         }
-        
-        // Cursor
-        char* cursor;
-        if (sd_journal_get_cursor(j, &cursor) >= 0) {
-            entry.cursor = QString::fromUtf8(cursor);
-            free(cursor);
+        m_liveKmsgNotifier->setEnabled(true);
+    }
+
+    if (!m_liveJournal) return;
+    if (!m_liveNotifier) {
+        const int fd = sd_journal_get_fd(m_liveJournal);
+        if (fd < 0) {
+            emit collectionError("Failed to watch systemd journal");
+            return;
         }
+        m_liveNotifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(m_liveNotifier, &QSocketNotifier::activated, this, &LogCollector::onJournalActivity);
+    }
+    m_liveNotifier->setEnabled(true);
+}
+
+void LogCollector::onKmsgActivity() {
+    // kmsg stays readable until the records are consumed; mute it until
+    // deliverLiveDelta() has read them and re-armed
+    m_liveKmsgNotifier->setEnabled(false);
+    if (!m_liveCoalesceTimer->isActive()) m_liveCoalesceTimer->start();
+}
+
+void LogCollector::onJournalActivity() {
+    if (!m_liveJournal) return;
+
+    // Drains the inotify fd; NOP means nothing relevant to readers changed
+    const int change = sd_journal_process(m_liveJournal);
+    if (change == SD_JOURNAL_INVALIDATE) m_liveInvalidated = true;
+    if (change != SD_JOURNAL_APPEND && change != SD_JOURNAL_INVALIDATE) return;
+
+    // First wakeup of a burst starts the frame timer; later ones ride along
+    if (!m_liveCoalesceTimer->isActive()) m_liveCoalesceTimer->start();
+}
+
+void LogCollector::deliverLiveDelta() {
+    if (!m_liveWatching) return;
+
+    const bool fullWindow = !m_livePrimed;
+    const auto entries = collectLiveIncremental(m_liveWindowMinutes);
+
+    // collectLiveIncremental() reopens the journal after a reset, which
+    // invalidates the old fd — re-arm on whatever handle is current.
+    armLiveNotifier();
+
+    if (fullWindow || !entries.isEmpty())
+        emit liveEntriesReady(entries, fullWindow, m_liveNewestEventUsec);
+}
+
+QVector<LogEntry> LogCollector::collectJournald(const QDateTime& since, int maxEntries) {
+    QVector<LogEntry> entries;
+    streamJournald(since, maxEntries, appendTo(entries));
+    return entries;
+}
+
+void LogCollector::streamJournald(const QDateTime& since, int maxEntries, const EntrySink& sink) {
+    sd_journal* j = nullptr;
+    if (sd_journal_open(&j, SD_JOURNAL_LOCAL_ONLY) < 0) {
+        emit collectionError("Failed to open systemd journal");
+        return;
+    }
+    // Filter: priority 0-4 (emergency through warning), plus unit/host
+    addJournalMatches(j);
+    // Anchor at the tail and walk backwards so the maxEntries cap keeps the
+    // most recent events; the result is already newest-first.
+    sd_journal_seek_tail(j);
+    readJournalBackward(j, since.toMSecsSinceEpoch() * 1000ULL, 0, maxEntries,
+                        sink, m_lastJournalStats);
+    if (m_lastJournalStats.truncated) {
+        qWarning() << "collectJournald: entry cap" << maxEntries
+                   << "reached before" << since << "- older entries were not collected";
+    }
+    sd_journal_close(j);
+}
+
+void LogCollector::streamJournaldSharded(const QDateTime& since, int maxEntries, int shards,
+                                         const EntrySink& sink) {
+    const quint64 sinceUsec = since.toMSecsSinceEpoch() * 1000ULL;
+    const quint64 nowUsec = QDateTime::currentMSecsSinceEpoch() * 1000ULL;
+    if (nowUsec <= sinceUsec) {
+        streamJournald(since, maxEntries, sink);
+        return;
+    }
+    const quint64 span = (nowUsec - sinceUsec + shards - 1) / shards;
+    
+    // Shard 0 is the newest. std::vector rather than QVector so workers can
+    // write their own slot without tripping implicit sharing.
+    std::vector<QVector<LogEntry>> shardEntries(shards);
+    std::vector<JournalScanStats> shardStats(shards);
+    std::vector<char> shardFailed(shards, 0);  // not vector<bool>: workers write concurrently
+    std::vector<QThread*> workers;
+    workers.reserve(shards);
+    
+    // The newest shard hands its entries over as it reads them, so the
+    // first batches go out long before the slowest shard finishes. The sink
+    // itself always runs on the calling thread.
+    QMutex handoffMutex;
+    QWaitCondition handoffReady;
+    QVector<LogEntry> handoff;
+    bool newestDone = false;
+    const EntrySink handoffSink = [&](LogEntry&& entry) {
+        QMutexLocker locker(&handoffMutex);
+        handoff.append(std::move(entry));
+        if (handoff.size() >= 256) handoffReady.wakeOne();
+    };
+    
+    for (int i = 0; i < shards; ++i) {
+        const quint64 upper = nowUsec - quint64(i) * span;
+        const quint64 lower = upper > sinceUsec + span ? upper - span : sinceUsec;
         
-        // Detect threats
-        entry.threats = ThreatDetector::detectThreats(entry.message, entry.unit);
-        entry.threatCount = entry.threats.size();
-        
-        if (entry.threatCount > 0) {
-            // Find max severity
-            QMap<QString, int> sevOrder = {{"critical", 0}, {"high", 1}, {"medium", 2}, {"low", 3}};
-            int minOrder = 99;
-            for (const auto& threat : entry.threats) {
-                int order = sevOrder.value(threat.severity, 99);
-                if (order < minOrder) {
-                    minOrder = order;
-                    entry.maxThreatSeverity = threat.severity;
+        workers.push_back(QThread::create([&, i, lower, upper, maxEntries]() {
+            sd_journal* j = nullptr;
+            if (sd_journal_open(&j, SD_JOURNAL_LOCAL_ONLY) < 0) {
+                shardFailed[i] = 1;
+            } else {
+                addJournalMatches(j);
+                // The newest shard starts at the tail and has no upper bound,
+                // so entries written while the scan runs are not lost between
+                // shards. Every shard may need the whole cap if the others
+                // turn out empty.
+                if (i == 0) {
+                    sd_journal_seek_tail(j);
+                    readJournalBackward(j, lower, 0, maxEntries, handoffSink, shardStats[i]);
+                } else {
+                    sd_journal_seek_realtime_usec(j, upper);
+                    readJournalBackward(j, lower, upper, maxEntries,
+                                        appendTo(shardEntries[i]), shardStats[i]);
                 }
+                sd_journal_close(j);
             }
+            if (i == 0) {
+                QMutexLocker locker(&handoffMutex);
+                newestDone = true;
+                handoffReady.wakeOne();
+            }
+        }));
+        workers.back()->start();
+    }
+    
+    // Drain the newest shard while it is still reading
+    for (;;) {
+        QVector<LogEntry> chunk;
+        bool done;
+        {
+            QMutexLocker locker(&handoffMutex);
+            if (handoff.isEmpty() && !newestDone) handoffReady.wait(&handoffMutex, 50);
+            chunk.swap(handoff);
+            done = newestDone;
         }
-        
-        tempEntries.append(entry);
+        for (LogEntry& entry : chunk) sink(std::move(entry));
+        if (done) break;
     }
-        qDebug() << "Loop completed. Ran" << loopCount << "times, collected" << tempEntries.size() << "entries";
-    sd_journal_close(j);
     
-    // Reverse to get newest first
-    std::reverse(tempEntries.begin(), tempEntries.end());
+    // Shards are disjoint and each is newest-first, so forwarding them newest
+    // shard first is already globally ordered.
+    m_lastJournalStats = JournalScanStats();
+    int failed = 0;
+    for (int i = 0; i < shards; ++i) {
+        workers[i]->wait();
+        delete workers[i];
+        
+        if (shardFailed[i]) {
+            ++failed;
+            m_lastJournalStats.truncated = true;
+            continue;
+        }
+        m_lastJournalStats.entriesTouched += shardStats[i].entriesTouched;
+        m_lastJournalStats.truncated |= shardStats[i].truncated;
+        if (i == 0) {
+            m_lastJournalStats.entriesKept = shardStats[i].entriesKept;
+            m_lastJournalStats.cancelled   = shardStats[i].cancelled;
+            continue;
+        }
+        m_lastJournalStats.cancelled |= shardStats[i].cancelled;
+        for (LogEntry& entry : shardEntries[i]) {
+            if (isScanCancelled()) break;
+            if (m_lastJournalStats.entriesKept >= maxEntries) {
+                m_lastJournalStats.truncated = true;
+                break;
+            }
+            sink(std::move(entry));
+            ++m_lastJournalStats.entriesKept;
+        }
+        shardEntries[i] = QVector<LogEntry>();
+    }
     
-    return tempEntries;
+    if (failed == shards) {
+        m_lastJournalStats = JournalScanStats();
+        emit collectionError("Failed to open systemd journal");
+        return;
+    }
+    if (m_lastJournalStats.truncated) {
+        qWarning() << "streamJournaldSharded: entry cap" << maxEntries
+                   << "reached before" << since << "- older entries were not collected";
+    }
+}
+
+QVector<LogEntry> LogCollector::collectDmesg(const QDateTime& since, quint64* sequence, quint64* lost) {
+    // Read the ring buffer directly when allowed; spawning dmesg is only
+    // needed under dmesg_restrict without CAP_SYSLOG, where sudo may help
+    KmsgReader kmsg;
+    if (!kmsg.open()) {
+        // The subprocess has no sequence numbers to resume from
+        if (sequence) *sequence = 0;
+        return collectDmesgProcess(since);
+    }
+    if (sequence && *sequence > 0) kmsg.setLastSequence(*sequence);
+    QVector<LogEntry> entries = finishKernelEntries(kmsg.readAvailable(since));
+    if (sequence) *sequence = kmsg.lastSequence();
+    if (lost) *lost = kmsg.droppedRecords();
+    return entries;
+}
+
+bool LogCollector::journalCoversKernel(const QDateTime& since) const {
+    if (!m_skipCoveredDmesg) return false;
+    // Kernel records carry no _SYSTEMD_UNIT, so a unit filter keeps them out
+    // of the journal read; a host filter may too
+    if (!m_unitFilter.isEmpty() || !m_hostFilter.isEmpty()) return false;
+
+    const QString bootId = currentBootId();
+    if (bootId.isEmpty()) return false;
+
+    sd_journal* j = nullptr;
+    if (sd_journal_open(&j, SD_JOURNAL_LOCAL_ONLY) < 0) return false;
+    const QByteArray transportMatch = "_TRANSPORT=kernel";
+    const QByteArray bootMatch = "_BOOT_ID=" + bootId.toLatin1();
+    sd_journal_add_match(j, transportMatch.constData(), transportMatch.size());
+    sd_journal_add_match(j, bootMatch.constData(), bootMatch.size());
+
+    // The ring buffer only ever holds the current boot, and journald keeps
+    // reading it from where it left off. If the journal's oldest kernel
+    // record of this boot predates the window, or was read when the boot
+    // began, the ring buffer has nothing in the window the journal lacks.
+    bool covered = false;
+    sd_journal_seek_head(j);
+    if (sd_journal_next(j) > 0) {
+        uint64_t usec = 0;
+        if (sd_journal_get_realtime_usec(j, &usec) >= 0)
+            covered = qint64(usec) <= since.toMSecsSinceEpoch() * 1000;
+
+        const void* data = nullptr;
+        size_t len = 0;
+        if (!covered && sd_journal_get_data(j, "_SOURCE_MONOTONIC_TIMESTAMP", &data, &len) >= 0) {
+            const QByteArray field(static_cast<const char*>(data), int(len));
+            const qint64 monotonicUsec = field.mid(field.indexOf('=') + 1).toLongLong();
+            covered = monotonicUsec <= kKernelBootCaptureUsec;
+        }
+    }
+    sd_journal_close(j);
+    return covered;
+}
+
+bool LogCollector::canSkipDmesg(const QDateTime& since) const {
+    // The ring buffer only ever holds the current boot
+    if (!m_bootFilter.isEmpty() && m_bootFilter != currentBootId()) return true;
+    return journalCoversKernel(since);
 }
 
-QVector<LogEntry> LogCollector::collectDmesg(const QDateTime& since) {
+int LogCollector::dropKernelDuplicates(QVector<LogEntry>& journal, const QVector<LogEntry>& kernel) {
+    if (kernel.isEmpty()) return 0;
+
+    KernelDedup seen;
+    for (const auto& entry : kernel) seen.add(entry);
+    const auto duplicate = std::remove_if(journal.begin(), journal.end(),
+        [&seen](const LogEntry& entry) { return seen.take(entry); });
+    const int dropped = int(journal.end() - duplicate);
+    journal.erase(duplicate, journal.end());
+    return dropped;
+}
+
+QVector<LogEntry> LogCollector::finishKernelEntries(QVector<LogEntry> entries) {
+    // Ring-buffer records always belong to the running boot
+    const QString bootId = currentBootId().left(8);
+    for (auto& entry : entries) {
+        if (isScanCancelled()) break;
+        entry.bootId = bootId;
+        entry.group = groupForPriority(entry.priority);
+    }
+    return entries;
+}
+
+QVector<LogEntry> LogCollector::collectDmesgProcess(const QDateTime& since) {
     QVector<LogEntry> entries;
     
     QProcess process;
@@ -208,10 +968,24 @@ QVector<LogEntry> LogCollector::collectDmesg(const QDateTime& since) {
         process.start("dmesg", args);
     }
     
-    if (!process.waitForFinished(15000)) {
+    // Poll rather than block for the whole timeout so a cancelled scan can
+    // give up on a slow dmesg right away
+    QElapsedTimer waited;
+    waited.start();
+    bool finished = false;
+    while (!(finished = process.waitForFinished(100))) {
+        if (process.state() == QProcess::NotRunning || waited.elapsed() >= 15000) break;
+        if (isScanCancelled()) {
+            process.kill();
+            process.waitForFinished();
+            return entries;
+        }
+    }
+    
+    if (!finished) {
         LogEntry error;
         error.source = "dmesg";
-        error.timestamp = QDateTime::currentDateTimeUtc();
+        error.timestampUsec = QDateTime::currentMSecsSinceEpoch() * 1000;
         error.group = "warning";
         error.priority = 4;
         error.unit = "dmesg-collector";
@@ -224,7 +998,7 @@ QVector<LogEntry> LogCollector::collectDmesg(const QDateTime& since) {
     if (process.exitCode() != 0) {
         LogEntry error;
         error.source = "dmesg";
-        error.timestamp = QDateTime::currentDateTimeUtc();
+        error.timestampUsec = QDateTime::currentMSecsSinceEpoch() * 1000;
         error.group = "warning";
         error.priority = 4;
         error.unit = "dmesg-collector";
@@ -235,64 +1009,33 @@ QVector<LogEntry> LogCollector::collectDmesg(const QDateTime& since) {
         return entries;
     }
     
-    QString output = QString::fromUtf8(process.readAllStandardOutput());
-    QStringList lines = output.split('\n', Qt::SkipEmptyParts);
+    const QByteArray output = process.readAllStandardOutput();
+    const qint64 sinceUsec = since.toMSecsSinceEpoch() * 1000;
+    const QString bootId = currentBootId().left(8);
+    DmesgParser parser;
+    DmesgLine parsed;
     
-    QRegularExpression isoPattern(R"(^(\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}[.,]\d+[+-]\d{4})\s+(.+)$)");
-    QRegularExpression levelPattern(R"(^\[\s*(\w+)\s*\]\s*(.*)$)");
-    
-    QMap<QString, int> levelMap = {
-        {"emerg", 0}, {"alert", 1}, {"crit", 2}, {"err", 3}, {"warn", 4}
-    };
-    
-    for (const QString& line : lines) {
-        QRegularExpressionMatch match = isoPattern.match(line);
-        if (!match.hasMatch()) continue;
-        
-        QString tsStr = match.captured(1);
-        QString rest = match.captured(2);
-        
-        // Parse timestamp
-        tsStr.replace(',', '.');
-        QDateTime timestamp = QDateTime::fromString(tsStr, Qt::ISODate);
-        if (!timestamp.isValid() || timestamp < since) continue;
+    const char* p = output.constData();
+    const char* const end = p + output.size();
+    while (p < end) {
+        if (isScanCancelled()) break;
+        const char* nl = static_cast<const char*>(memchr(p, '\n', end - p));
+        const char* lineEnd = nl ? nl : end;
+        const char* line = p;
+        p = lineEnd + 1;
         
-        // Extract level
-        QRegularExpressionMatch levelMatch = levelPattern.match(rest);
-        QString levelStr = "err";
-        QString message = rest;
-        if (levelMatch.hasMatch()) {
-            levelStr = levelMatch.captured(1).toLower();
-            message = levelMatch.captured(2);
-        }
-        
-        int priority = levelMap.value(levelStr, 3);
-        QString group = groupForPriority(priority);
+        if (!parser.parse(line, size_t(lineEnd - line), parsed)) continue;
+        if (parsed.epochUsec < sinceUsec) continue;
         
         LogEntry entry;
         entry.source = "dmesg";
-        entry.timestamp = timestamp;
-        entry.group = group;
-        entry.priority = priority;
+        entry.timestampUsec = parsed.epochUsec;
+        entry.group = groupForPriority(parsed.priority);
+        entry.priority = parsed.priority;
         entry.unit = "kernel";
-        entry.message = message;
+        entry.message = QString::fromUtf8(parsed.message, parsed.messageLen);
         entry.transport = "kernel";
-        
-        // Detect threats
-        entry.threats = ThreatDetector::detectThreats(entry.message, entry.unit);
-        entry.threatCount = entry.threats.size();
-        
-        if (entry.threatCount > 0) {
-            QMap<QString, int> sevOrder = {{"critical", 0}, {"high", 1}, {"medium", 2}, {"low", 3}};
-            int minOrder = 99;
-            for (const auto& threat : entry.threats) {
-                int order = sevOrder.value(threat.severity, 99);
-                if (order < minOrder) {
-                    minOrder = order;
-                    entry.maxThreatSeverity = threat.severity;
-                }
-            }
-        }
+        entry.bootId = bootId;
         
         entries.append(entry);
     }
@@ -2,33 +2,278 @@
 #define LOGCOLLECTOR_H
 
 #include "logentry.h"
+#include "kerneldedup.h"
+#include "correlationengine.h"
 #include <QVector>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QObject>
+#include <QStringList>
+#include <atomic>
+#include <functional>
+
+struct sd_journal;
+class KmsgReader;
+class QSocketNotifier;
+class QTimer;
+
+// Journal iteration counters for the most recent collection. entriesTouched
+// counts every entry the iterator visited; entriesKept those that survived
+// the in-loop filters and were returned. truncated is set when the entry cap
+// was hit before reaching the start of the window, i.e. the oldest part of
+// the window is missing. cancelled is set when the collection was aborted
+// through LogCollector::cancelScan(). kernelRecordsLost counts /dev/kmsg
+// records a resumed scan found overwritten since the checkpoint.
+struct JournalScanStats {
+    qint64 entriesTouched = 0;
+    qint64 entriesKept    = 0;
+    bool   truncated      = false;
+    bool   cancelled      = false;
+    qint64 kernelRecordsLost = 0;
+};
 
 class LogCollector : public QObject {
     Q_OBJECT
     
 public:
     explicit LogCollector(QObject* parent = nullptr);
+    ~LogCollector();
     
     // Collect logs from journald and dmesg
     QVector<LogEntry> collectAll(int lookbackDays = 7);
     QVector<LogEntry> collectLive(int windowMinutes = 60);
+
+    // Collections run threat detection, entity extraction and template
+    // mining (TemplateMiner::shared()) and then CorrelationEngine over the
+    // result, so they may contain synthetic "correlation" entries.
+
+    // Streaming variant of collectAll(): entries are delivered newest-first
+    // through batchReady() in batches of batchSize, followed by
+    // collectionComplete(). dmesg lines are interleaved by timestamp, so the
+    // concatenated batches are globally ordered and a consumer can append
+    // each one to the tail of what it already has.
+    void collectAllStreaming(int lookbackDays = 7, int batchSize = 1000);
+
+    // Asynchronous collectAllStreaming(): queues the scan on the collector's
+    // thread and returns its id at once. Any scan still running or queued
+    // is cancelled, so only the newest request runs to completion.
+    // Thread-safe.
+    quint64 requestScan(int lookbackDays = 7, int batchSize = 1000);
+    // Cooperatively cancels the running scan. The journal walk, the shard
+    // workers and the dmesg reader check between entries. Thread-safe.
+    void cancelScan() { ++m_scanGeneration; }
+    // Id of the scan currently (or last) running; only meaningful on the
+    // collector's thread, e.g. in a handler directly connected to its signals.
+    quint64 activeScanId() const { return m_activeScan; }
+
+    // Optional journal-side filters, applied as sd_journal_add_match() terms
+    // alongside the PRIORITY=0..4 matches. Empty lists mean "any". Take
+    // effect on the next collection (live handles are reopened).
+    void setUnitFilter(const QStringList& units);
+    void setHostFilter(const QStringList& hosts);
+    // Restricts collection to one boot (full 32-character _BOOT_ID); empty
+    // means every boot. The kernel ring buffer only holds the current boot,
+    // so dmesg is not read while a previous boot is targeted.
+    void setBootFilter(const QString& bootId);
+    QString bootFilter() const { return m_bootFilter; }
+
+    // Boots recorded in the local journal, newest first: the _BOOT_ID values
+    // from sd_journal_query_unique() with each boot's first and last entry
+    // time. Opens its own journal handle, so it is safe on any thread.
+    QVector<JournalBoot> bootIndex() const;
+
+    JournalScanStats lastJournalStats() const { return m_lastJournalStats; }
+
+    // Resume point for the next streaming scan, normally the checkpoint the
+    // previous run stored. The scan then reads only journal entries from the
+    // checkpoint's entry on (and kmsg records after its sequence number).
+    // It falls back to the full window when the cursor's entry is gone, the
+    // filters changed, or the window reaches further back than the scans
+    // behind the checkpoint did. Consumed by the next scan.
+    void setResumeCheckpoint(const ScanCheckpoint& checkpoint) { m_resumeCheckpoint = checkpoint; }
+    // Where the last completed streaming scan got to; store it and hand it
+    // back through setResumeCheckpoint() next time
+    ScanCheckpoint lastCheckpoint() const { return m_lastCheckpoint; }
+    // Whether the last streaming scan resumed from a checkpoint
+    bool lastScanResumed() const { return m_lastScanResumed; }
+
+    // journald kernel records dropped by the last collection because the
+    // same message was also read from the ring buffer (see KernelDedup)
+    int lastKernelDuplicates() const { return m_lastKernelDuplicates; }
+    // Whether the last collection skipped the ring buffer, because the
+    // journal already holds this boot's kernel records for the window or
+    // because a previous boot is targeted
+    bool lastDmesgSkipped() const { return m_lastDmesgSkipped; }
+    // Allows that skip. On by default; dedup applies either way.
+    void setSkipCoveredDmesg(bool skip) { m_skipCoveredDmesg = skip; }
+    bool skipCoveredDmesg() const { return m_skipCoveredDmesg; }
+
+    // Worker threads for the collectAll() journal scan. The window is split
+    // into this many time shards, each walked on its own thread with its own
+    // journal handle. 1 scans on the calling thread. Defaults to
+    // QThread::idealThreadCount().
+    void setScanWorkers(int workers);
+    int scanWorkers() const { return m_scanWorkers; }
+
+    // Incremental live collection. The journal handle stays open between
+    // calls and only entries written after the last delivered cursor are
+    // returned (newest first). The first call after construction or
+    // resetLiveCursor() returns the full window. Evicting entries that fall
+    // out of the window is the consumer's job.
+    QVector<LogEntry> collectLiveIncremental(int windowMinutes = 60);
+    bool isLivePrimed() const { return m_livePrimed; }
+    void resetLiveCursor();
+
+    // Realtime timestamp (usec) of the newest journal entry returned by the
+    // last collectLiveIncremental() call, or 0 if it returned none.
+    qint64 lastLiveEventUsec() const { return m_liveNewestEventUsec; }
+
+    // Push-driven live mode. Watches the journal fd with a QSocketNotifier,
+    // so it must be called on the thread this collector lives on. Journal
+    // changes arriving within one frame budget are coalesced into a single
+    // liveEntriesReady() emission. Calling again updates the window. When
+    // kernel records can only come from the dmesg subprocess, it is run at
+    // most once per dmesgIntervalMs rather than on every journal wakeup.
+    void startLiveWatch(int windowMinutes = 60, int dmesgIntervalMs = 5000);
+    void stopLiveWatch();
+    bool isLiveWatching() const { return m_liveWatching; }
     
 signals:
+    // Streaming scan progress: how much of [since, now] the newest-first
+    // stream has covered so far, estimated from entry timestamps.
     void collectionProgress(int current, int total);
     void collectionComplete(int entryCount);
     void collectionError(const QString& error);
+    // Emitted instead of collectionComplete() when a scan is cancelled or
+    // superseded before it finished.
+    void collectionCancelled(quint64 scanId);
+
+    // Streaming scan start, ahead of its first batch. resumed is
+    // lastScanResumed(): false when the checkpoint handed in was unusable
+    // and the whole window is read again.
+    void scanStarted(quint64 scanId, bool resumed);
+
+    // Streaming scan delivery; each batch is older than the previous one.
+    // Emitted on the thread that called collectAllStreaming(). scanId tells
+    // batches of a superseded scan apart from the current one.
+    void batchReady(const QVector<LogEntry>& batch, quint64 scanId);
+
+    // Push-mode delivery. fullWindow is true on the priming delivery;
+    // newestEventUsec is the realtime timestamp of the newest journal entry
+    // in the batch (0 if none) for event-to-screen latency measurement.
+    void liveEntriesReady(const QVector<LogEntry>& entries, bool fullWindow,
+                          qint64 newestEventUsec);
+
+private slots:
+    void onJournalActivity();
+    void onKmsgActivity();
+    void deliverLiveDelta();
     
 private:
+    // Receives journal entries one at a time, newest first
+    using EntrySink = std::function<void(LogEntry&&)>;
+
+    void streamScan(int lookbackDays, int batchSize, quint64 scanId);
+    // Filter signature a journal checkpoint is only valid under
+    QString journalScope() const;
+    // Realtime usec of the checkpoint's journal entry when the scan can
+    // resume from it, 0 when the whole window has to be read
+    qint64 checkpointUsec(const ScanCheckpoint& checkpoint, qint64 windowStartUsec) const;
+    bool isScanCancelled() const {
+        return m_scanGeneration.load(std::memory_order_relaxed) != m_activeScan;
+    }
+
     QVector<LogEntry> collectJournald(const QDateTime& since, int maxEntries = 10000);
-    QVector<LogEntry> collectDmesg(const QDateTime& since);
+    void streamJournald(const QDateTime& since, int maxEntries, const EntrySink& sink);
+    // Shard 0 (the newest) is forwarded to sink while it is still being
+    // read; older shards are buffered and forwarded in order once they
+    // finish. Every shard, even a lone one, is read on a thread of its own
+    // and sink only ever runs on the calling thread, so the readers never
+    // wait on what sink does.
+    void streamJournaldSharded(const QDateTime& since, int maxEntries, int shards,
+                               const EntrySink& sink);
+    // Kernel log: /dev/kmsg when readable, else the dmesg subprocess. With
+    // sequence, kmsg records up to *sequence are skipped and *sequence is
+    // set to the last record read (0 when the subprocess was used); lost
+    // receives the records overwritten past *sequence before they were read.
+    QVector<LogEntry> collectDmesg(const QDateTime& since, quint64* sequence = nullptr,
+                                   quint64* lost = nullptr);
+    QVector<LogEntry> collectDmesgProcess(const QDateTime& since);
+    // Fills boot and group fields of entries read from /dev/kmsg
+    QVector<LogEntry> finishKernelEntries(QVector<LogEntry> entries);
+    // True when reading the ring buffer would add nothing: no unit/host
+    // filter hides kernel records from the journal read, and the journal
+    // holds this boot's _TRANSPORT=kernel records from before since or from
+    // the start of the boot. Always false when setSkipCoveredDmesg(false).
+    bool journalCoversKernel(const QDateTime& since) const;
+    // journalCoversKernel(), or the boot filter excludes the current boot
+    bool canSkipDmesg(const QDateTime& since) const;
+    // Removes journald kernel records that duplicate an entry of kernel;
+    // returns how many were removed
+    static int dropKernelDuplicates(QVector<LogEntry>& journal, const QVector<LogEntry>& kernel);
     
     LogEntry parseJournaldEntry(const QByteArray& jsonLine, const QDateTime& since);
     LogEntry parseDmesgLine(const QString& line, const QDateTime& since);
     
     QString groupForPriority(int priority);
+
+    // Reads the entry at the journal's current position. Returns false when
+    // the entry's priority is outside 0-4.
+    bool readJournalEntry(sd_journal* j, LogEntry& entry);
+    // Registers PRIORITY/unit/host matches so libsystemd's entry arrays skip
+    // non-matching entries instead of the loop reading and discarding them.
+    void addJournalMatches(sd_journal* j) const;
+    // Walks backwards from the current position (normally the tail), passing
+    // entries to sink newest-first until maxEntries or the first entry
+    // before sinceUsec. Entries at or after untilUsec are skipped (0 = no
+    // upper bound). Stops early if the scan is cancelled. Writes no members,
+    // so shard workers can run it concurrently. newestCursor, if given, receives the cursor of the first
+    // (newest) in-window entry visited.
+    void readJournalBackward(sd_journal* j, quint64 sinceUsec, quint64 untilUsec,
+                             int maxEntries, const EntrySink& sink,
+                             JournalScanStats& stats, QString* newestCursor = nullptr);
+    bool openLiveJournal();
+    void closeLiveJournal();
+    void armLiveNotifier();
+    bool openLiveKmsg();
+    void closeLiveKmsg();
+
+    QStringList      m_unitFilter;
+    QStringList      m_hostFilter;
+    QString          m_bootFilter;
+    JournalScanStats m_lastJournalStats;
+    int              m_scanWorkers;
+    bool             m_skipCoveredDmesg = true;
+    bool             m_lastDmesgSkipped = false;
+    int              m_lastKernelDuplicates = 0;
+    ScanCheckpoint   m_resumeCheckpoint;
+    ScanCheckpoint   m_lastCheckpoint;
+    bool             m_lastScanResumed = false;
+
+    // Bumped by cancelScan()/requestScan(); a collection is cancelled once
+    // it no longer matches the generation it started under (m_activeScan).
+    std::atomic<quint64> m_scanGeneration{0};
+    quint64              m_activeScan = 0;
+
+    sd_journal* m_liveJournal = nullptr;
+    QString     m_liveCursor;        // cursor of the newest delivered journal entry
+    KmsgReader* m_liveKmsg = nullptr; // resumes by record sequence between polls
+    qint64      m_liveDmesgHighWater = 0; // newest delivered dmesg usec (subprocess fallback)
+    bool        m_livePrimed = false; // full window delivered at least once
+    bool        m_liveInvalidated = false; // journal files rotated since last read
+    qint64      m_liveNewestEventUsec = 0;
+    bool        m_liveDmesgSkipped = false; // decided on the priming poll
+    KernelDedup m_liveKernelSeen;    // ring-buffer records of the window, for journald copies in later polls
+    CorrelationEngine m_liveCorrelation;  // bursts spanning several live polls
+
+    // Push mode
+    QSocketNotifier* m_liveNotifier = nullptr;
+    QSocketNotifier* m_liveKmsgNotifier = nullptr;
+    QTimer*          m_liveCoalesceTimer = nullptr;
+    bool             m_liveWatching = false;
+    int              m_liveWindowMinutes = 60;
+    int              m_liveDmesgIntervalMs = 5000;
+    QElapsedTimer    m_liveDmesgLastRun;  // last dmesg subprocess run in push mode
 };
 
 #endif // LOGCOLLECTOR_H
@@ -14,9 +14,69 @@ struct ThreatMatch {
     QString pattern;
 };
 
+// An address, user name or port named in a message, as pulled out by
+// EntityExtractor. key() ("ip:10.0.0.1") is the form the search box and
+// the inverted indexes use.
+struct LogEntity {
+    enum Kind : quint8 { Ip = 0, User = 1, Port = 2 };
+
+    Kind    kind = Ip;
+    QString value;
+
+    static QString kindName(Kind kind) {
+        switch (kind) {
+        case Ip:   return "ip";
+        case User: return "user";
+        case Port: return "port";
+        }
+        return QString();
+    }
+    QString key() const { return kindName(kind) + ':' + value; }
+
+    // Reverse of key(); false if text is not "<kind>:<value>"
+    static bool parse(const QString& text, LogEntity& entity) {
+        const int colon = text.indexOf(':');
+        if (colon <= 0 || colon == text.size() - 1) return false;
+        const QString name = text.left(colon);
+        for (Kind kind : {Ip, User, Port}) {
+            if (name == kindName(kind)) {
+                entity.kind = kind;
+                entity.value = text.mid(colon + 1);
+                if (kind == Ip) entity.value = entity.value.toLower();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool operator==(const LogEntity& other) const {
+        return kind == other.kind && value == other.value;
+    }
+};
+
+// One boot recorded in the journal. bootId is the full 32-character id;
+// LogEntry::bootId carries only its first 8 characters.
+struct JournalBoot {
+    QString bootId;
+    qint64  firstUsec = 0;  // realtime of the boot's oldest journal entry
+    qint64  lastUsec  = 0;  // ... and of its newest
+};
+
+// How far a scan got, so the next one only reads what is new. Produced by
+// LogCollector, stored between runs by PersistenceManager.
+struct ScanCheckpoint {
+    QString journalCursor;        // newest journal entry delivered
+    QString journalScope;         // unit/host/boot filters it was taken under
+    qint64  coveredFromUsec = 0;  // oldest point the scans behind it reached
+    QString kmsgBootId;           // boot the kmsg sequence number belongs to
+    quint64 kmsgSequence = 0;     // last /dev/kmsg record read
+
+    bool isEmpty() const { return journalCursor.isEmpty() && kmsgSequence == 0; }
+};
+
 struct LogEntry {
     QString source;        // journald or dmesg
-    QDateTime timestamp;
+    qint64 timestampUsec = 0;  // UTC microseconds since epoch; sort/filter/bucket key
     QString group;         // critical, error, warning
     int priority;          // 0-4 journald priority
     QString unit;
@@ -29,12 +89,27 @@ struct LogEntry {
     QString messageId;
     QString transport;
     QString cursor;
+    QString subsystem;     // kernel records: /dev/kmsg SUBSYSTEM= dictionary entry
+    QString device;        // kernel records: /dev/kmsg DEVICE= dictionary entry
+    qint64 kernelUsec = 0; // journald kernel records: when the kernel logged it, on the /dev/kmsg clock
     
     // Security threat fields
     QVector<ThreatMatch> threats;
     int threatCount = 0;
     QString maxThreatSeverity;  // highest severity among all threats
+
+    QVector<LogEntity> entities;
+    quint32 templateId = 0;     // TemplateMiner::shared() id, 0 = not mined
     
+    // Timestamp conversions — QDateTime is for display and API edges only
+    QDateTime dateTime() const {
+        return QDateTime::fromMSecsSinceEpoch(timestampUsec / 1000, Qt::UTC);
+    }
+
+    void setDateTime(const QDateTime& dt) {
+        timestampUsec = dt.toMSecsSinceEpoch() * 1000;
+    }
+
     // Display fields (computed)
     QString severityLabel() const {
         if (group == "critical") return "⛔ CRITICAL";
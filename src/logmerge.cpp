@@ -0,0 +1,78 @@
+#include "logmerge.h"
+#include <algorithm>
+#include <queue>
+
+static inline qint64 sortKey(const LogEntry& entry) {
+    return entry.timestampUsec;
+}
+
+void makeNewestFirst(QVector<LogEntry>& run) {
+    if (run.size() < 2) return;
+
+    // One pass to classify, with each key computed once
+    std::vector<qint64> keys;
+    keys.reserve(run.size());
+    for (const auto& entry : run) keys.push_back(sortKey(entry));
+
+    bool descending = true, ascending = true;
+    for (size_t i = 1; i < keys.size() && (descending || ascending); ++i) {
+        if (keys[i] > keys[i - 1]) descending = false;
+        if (keys[i] < keys[i - 1]) ascending = false;
+    }
+    if (descending) return;
+    if (ascending) {
+        std::reverse(run.begin(), run.end());
+        return;
+    }
+
+    // Sort an index on the cached keys, then move entries into place once
+    std::vector<int> order(run.size());
+    for (int i = 0; i < run.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&keys](int a, int b) {
+        return keys[a] > keys[b];
+    });
+    QVector<LogEntry> sorted;
+    sorted.reserve(run.size());
+    for (int i : order) sorted.append(std::move(run[i]));
+    run = std::move(sorted);
+}
+
+QVector<LogEntry> mergeNewestFirst(std::vector<QVector<LogEntry>> runs) {
+    // Drop empty runs; zero or one left needs no merge at all
+    runs.erase(std::remove_if(runs.begin(), runs.end(),
+                              [](const QVector<LogEntry>& run) { return run.isEmpty(); }),
+               runs.end());
+    if (runs.empty()) return {};
+    if (runs.size() == 1) return std::move(runs.front());
+
+    struct Head {
+        qint64 key;
+        int    run;
+        int    pos;
+    };
+    // Max-heap on key; the lower run index wins ties so the merge is stable
+    auto after = [](const Head& a, const Head& b) {
+        return a.key != b.key ? a.key < b.key : a.run > b.run;
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(after)> heap(after);
+
+    qsizetype total = 0;
+    for (int r = 0; r < int(runs.size()); ++r) {
+        total += runs[r].size();
+        heap.push({sortKey(runs[r].first()), r, 0});
+    }
+
+    QVector<LogEntry> merged;
+    merged.reserve(total);
+    while (!heap.empty()) {
+        Head head = heap.top();
+        heap.pop();
+        QVector<LogEntry>& run = runs[head.run];
+        merged.append(std::move(run[head.pos]));
+        if (++head.pos < run.size()) {
+            head.key = sortKey(run[head.pos]);
+            heap.push(head);
+        }
+    }
+    return merged;
+}
@@ -0,0 +1,23 @@
+#ifndef LOGMERGE_H
+#define LOGMERGE_H
+
+#include "logentry.h"
+#include <QVector>
+#include <vector>
+
+// Combining time-ordered log sources without re-sorting the whole set.
+// Each source ("run") is brought into newest-first order on its own — most
+// already are, or are oldest-first and just need reversing — and the runs
+// are then merged with a k-way heap on int64 timestamp keys. Entries are
+// moved, never copied or swapped, so the ~14 QStrings of a LogEntry are
+// touched once. Adding a source costs O(n log k), not another full sort.
+
+// Puts one run into newest-first order: no-op if it already is, a reverse if
+// it is oldest-first, a stable sort only if it is neither.
+void makeNewestFirst(QVector<LogEntry>& run);
+
+// Merges newest-first runs into one newest-first vector. On equal
+// timestamps, entries of earlier runs come first. The runs are consumed.
+QVector<LogEntry> mergeNewestFirst(std::vector<QVector<LogEntry>> runs);
+
+#endif // LOGMERGE_H
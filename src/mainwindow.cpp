@@ -1,4 +1,5 @@
 #include "mainwindow.h"
+#include "threatdetector.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QStatusBar>
@@ -36,6 +37,7 @@ MainWindow::MainWindow(int lookbackDays, int liveWindowMinutes, int livePollSeco
     , m_liveThread(new QThread(this))
     , m_persistence(new PersistenceManager(this))
     , m_settingsDrawer(nullptr)  // constructed after setupUI so parent geometry is known
+    , m_ruleWatcher(new ThreatRuleWatcher(ThreatRuleWatcher::defaultRulesPath(), this))
 {
     setWindowTitle("Error Surface");
     resize(1400, 900);
@@ -62,13 +64,32 @@ MainWindow::MainWindow(int lookbackDays, int liveWindowMinutes, int livePollSeco
         const int purged = m_persistence->purgeExpired();
         if (purged > 0) qDebug() << "Purged" << purged << "expired records on startup";
     }
+
+    // Rule file edits apply to entries collected from then on
+    connect(m_ruleWatcher, &ThreatRuleWatcher::rulesReloaded, this, [this](int rules, int patterns, qint64 ms) {
+        qDebug() << "Threat rules loaded from" << m_ruleWatcher->path() << ":" << rules << "rules,"
+                 << patterns << "patterns, compiled in" << ms << "ms";
+        if (!m_scanRunning)
+            m_statusLabel->setText(QString("Threat rules reloaded · %1 rules, %2 patterns").arg(rules).arg(patterns));
+    });
+    connect(m_ruleWatcher, &ThreatRuleWatcher::rulesError, this, [this](const QString& error) {
+        qWarning() << "Threat rules not loaded:" << error;
+        if (!m_scanRunning) m_statusLabel->setText("Threat rules not loaded · " + error);
+    });
 }
 
 MainWindow::~MainWindow() {
+    // Don't sit out a long scan on the way down
+    if (m_scanCollector) m_scanCollector->cancelScan();
     m_scanThread->quit();
     m_liveThread->quit();
     m_scanThread->wait();
     m_liveThread->wait();
+    // The live collector has no parent (it lives on m_liveThread) and holds
+    // an open journal handle between polls.
+    delete m_liveCollector;
+    delete m_scanCollector;
+    delete m_scanPersistence;
 }
 
 // ---------------------------------------------------------------------------
@@ -107,7 +128,7 @@ void MainWindow::setupUI() {
             border-bottom: 1px solid #22222e;
             padding: 16px 24px;
         }
-        QSpinBox, QLabel {
+        QSpinBox, QComboBox, QLabel {
             background: #0d0d0f;
             color: #c8c8d4;
             border: 1px solid #22222e;
@@ -168,10 +189,29 @@ void MainWindow::setupUI() {
     daysSpinBox->setMinimumWidth(60);
     connect(daysSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int days) {
         m_lookbackDays = days;
+        // A scan over the old range is stale now — replace it
+        if (m_scanRunning) {
+            m_statusLabel->setText(QString("Rescanning %1 days…").arg(days));
+            startScan();
+        }
     });
     headerLayout->addWidget(daysSpinBox);
     headerLayout->addSpacing(20);
 
+    // Scan workers
+    auto* workersLabel = new QLabel("Scan Workers:");
+    workersLabel->setStyleSheet("border: none; background: transparent; padding: 0;");
+    headerLayout->addWidget(workersLabel);
+    auto* workersSpinBox = new QSpinBox();
+    workersSpinBox->setRange(1, 256);
+    workersSpinBox->setValue(qMax(1, m_scanWorkers));
+    workersSpinBox->setMinimumWidth(60);
+    connect(workersSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int workers) {
+        m_scanWorkers = workers;  // picked up by the next scan
+    });
+    headerLayout->addWidget(workersSpinBox);
+    headerLayout->addSpacing(20);
+
     // Live window
     auto* liveLabel = new QLabel("Live Window (min):");
     liveLabel->setStyleSheet("border: none; background: transparent; padding: 0;");
@@ -182,6 +222,17 @@ void MainWindow::setupUI() {
     liveWindowSpinBox->setMinimumWidth(60);
     connect(liveWindowSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int mins) {
         m_liveWindowMinutes = mins;
+        // A wider window needs entries the live tab never received, so
+        // have the next poll deliver the full window again.
+        if (m_liveCollector) {
+            const int pollMs = m_livePollSeconds * 1000;
+            QMetaObject::invokeMethod(m_liveCollector, [this, mins, pollMs]() {
+                m_liveCollector->resetLiveCursor();
+                if (m_liveCollector->isLiveWatching())
+                    m_liveCollector->startLiveWatch(mins, pollMs);
+            }, Qt::QueuedConnection);
+        }
+        updateLiveTabTitle();
     });
     headerLayout->addWidget(liveWindowSpinBox);
     headerLayout->addSpacing(20);
@@ -196,21 +247,38 @@ void MainWindow::setupUI() {
     pollSpinBox->setMinimumWidth(60);
     connect(pollSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int secs) {
         m_livePollSeconds = secs;
-        m_liveTab->stopLiveUpdates();
-        m_liveTab->startLiveUpdates(secs * 1000);
+        if (m_liveMode == LiveMode::Poll) {
+            m_liveTab->stopLiveUpdates();
+            m_liveTab->startLiveUpdates(secs * 1000);
+        } else if (m_liveCollector) {
+            // Paces push mode's dmesg subprocess fallback
+            applyLiveMode();
+        }
+        updateLiveTabTitle();
     });
     headerLayout->addWidget(pollSpinBox);
     headerLayout->addSpacing(20);
 
+    // Live mode
+    auto* modeLabel = new QLabel("Live Mode:");
+    modeLabel->setStyleSheet("border: none; background: transparent; padding: 0;");
+    headerLayout->addWidget(modeLabel);
+    auto* modeCombo = new QComboBox();
+    modeCombo->addItem("Push", static_cast<int>(LiveMode::Push));
+    modeCombo->addItem("Poll", static_cast<int>(LiveMode::Poll));
+    modeCombo->setCurrentIndex(modeCombo->findData(static_cast<int>(m_liveMode)));
+    connect(modeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this, modeCombo](int) {
+        setLiveMode(static_cast<LiveMode>(modeCombo->currentData().toInt()));
+    });
+    headerLayout->addWidget(modeCombo);
+    headerLayout->addSpacing(20);
+
     // Refresh button
     auto* refreshBtn = new QPushButton("↻ Refresh Scan");
     connect(refreshBtn, &QPushButton::clicked, this, [this]() {
+        if (!m_scanCollector) return;
         m_statusLabel->setText("Refreshing scan…");
-        QApplication::processEvents();
-        auto entries = m_scanCollector->collectAll(m_lookbackDays);
-        mergeAndDisplay(entries);
-        m_statusLabel->setText(QString("Scan refreshed · %1 entries").arg(m_scanTab->entryCount()));
-        m_tabs->setTabText(0, QString("◉  SCAN  —  %1d historical").arg(m_lookbackDays));
+        startScan();
     });
     headerLayout->addWidget(refreshBtn);
     headerLayout->addSpacing(12);
@@ -265,8 +333,8 @@ void MainWindow::setupUI() {
     m_liveTab = new StatsTab("live");
 
     m_tabs->addTab(m_scanTab, QString("◉  SCAN  —  %1d historical").arg(m_lookbackDays));
-    m_tabs->addTab(m_liveTab, QString("●  LIVE  —  %1min / %2s poll")
-                              .arg(m_liveWindowMinutes).arg(m_livePollSeconds));
+    m_tabs->addTab(m_liveTab, QString());
+    updateLiveTabTitle();
 
     mainLayout->addWidget(m_tabs);
 
@@ -290,6 +358,9 @@ void MainWindow::setupUI() {
 // ---------------------------------------------------------------------------
 
 void MainWindow::startCollections() {
+    // Step 0: Rules from the config dir, if any, compile while the UI comes up
+    m_ruleWatcher->start();
+
     // Step 1: Load persisted events immediately so the dashboard is populated
     // before the first scan completes.
     if (m_persistence->isOpen()) {
@@ -303,54 +374,245 @@ void MainWindow::startCollections() {
     // Step 2: Defer the actual journal scan so the UI can render first
     QTimer::singleShot(150, this, [this]() {
         qDebug() << "Starting journal scan…";
-        m_scanCollector = new LogCollector(this);
-        const auto freshEntries = m_scanCollector->collectAll(m_lookbackDays);
-        qDebug() << "Scan collected:" << freshEntries.size() << "entries";
+        m_scanCollector = new LogCollector();
+        m_scanCollector->moveToThread(m_scanThread);
+        m_scanPersistence = new PersistenceManager();
+        m_scanPersistence->moveToThread(m_scanThread);
+
+        // Scan-thread side: both objects live on m_scanThread, so these run
+        // inline with the scan and the upsert never crosses threads.
+        connect(m_scanCollector, &LogCollector::batchReady, m_scanPersistence,
+                [this](const QVector<LogEntry>& batch, quint64) {
+            m_scanStreamed += batch.size();
+            if (m_scanPersistence->isOpen())
+                m_scanNewEvents += m_scanPersistence->upsertEvents(batch, false);
+        });
+        connect(m_scanCollector, &LogCollector::collectionComplete, m_scanPersistence, [this](int) {
+            QVector<LogEntry> active;
+            if (m_scanPersistence->isOpen()) {
+                // One audit row per scan, not per batch
+                m_scanPersistence->recordScanRun(m_scanNewEvents, m_scanStreamed - m_scanNewEvents);
+                // Only a completed scan moves the checkpoint; a cancelled one
+                // may have left a gap. One cut short by the entry cap only
+                // claims coverage back to its oldest entry.
+                m_scanPersistence->saveScanCheckpoint(m_scanCollector->lastCheckpoint());
+                // Full active set (persisted + fresh, deduped by fingerprint)
+                active = m_scanPersistence->loadActiveEvents();
+            }
+            m_scanStreamed = m_scanNewEvents = 0;
+            const quint64 scanId = m_scanCollector->activeScanId();
+            const JournalScanStats stats = m_scanCollector->lastJournalStats();
+            const QVector<JournalBoot> boots = m_scanCollector->bootIndex();
+            QMetaObject::invokeMethod(this, [this, scanId, active, stats, boots]() {
+                finishScan(scanId, active, stats, boots);
+            }, Qt::QueuedConnection);
+        });
+        connect(m_scanCollector, &LogCollector::collectionCancelled, m_scanPersistence, [this](quint64) {
+            // Batches already upserted stay; the superseding scan re-upserts
+            // them idempotently.
+            m_scanStreamed = m_scanNewEvents = 0;
+        });
 
-        mergeAndDisplay(freshEntries);
+        // GUI side
+        connect(m_scanCollector, &LogCollector::scanStarted, this, [this](quint64 scanId, bool resumed) {
+            // The collector may have fallen back to a full window scan, which
+            // streams into the tab like a first scan
+            if (scanId == m_scanId) m_scanResuming = resumed;
+        }, Qt::QueuedConnection);
+        connect(m_scanCollector, &LogCollector::batchReady,
+                this, &MainWindow::applyScanBatch, Qt::QueuedConnection);
+        connect(m_scanCollector, &LogCollector::collectionProgress, this, [this](int current, int total) {
+            if (!m_scanRunning || total <= 0) return;
+            m_statusLabel->setText(QString("Scanning… %1% · %2 entries")
+                                   .arg(current * 100 / total)
+                                   .arg(m_scanBatchEntries));
+        }, Qt::QueuedConnection);
+        m_scanThread->start();
+        startScan();
 
         // Step 3: Set up live collector
         m_liveCollector = new LogCollector();
         m_liveCollector->moveToThread(m_liveThread);
 
+        // Poll mode: the live tab's timer drives an incremental collection
         connect(m_liveTab, &StatsTab::needsRefresh, this, [this]() {
-            QMetaObject::invokeMethod(m_liveCollector, [this]() {
-                const auto entries = m_liveCollector->collectLive(m_liveWindowMinutes);
-                QMetaObject::invokeMethod(this, [this, entries]() {
-                    m_liveTab->setData(entries);
-                    m_statusLabel->setText(QString("Live · %1 entries").arg(entries.size()));
+            // Read on the GUI thread, which is the one that changes it
+            const int windowMinutes = m_liveWindowMinutes;
+            QMetaObject::invokeMethod(m_liveCollector, [this, windowMinutes]() {
+                // Only entries written since the previous poll come back,
+                // except on the priming poll which delivers the full window.
+                const bool fullWindow = !m_liveCollector->isLivePrimed();
+                const auto entries = m_liveCollector->collectLiveIncremental(windowMinutes);
+                const qint64 newestUsec = m_liveCollector->lastLiveEventUsec();
+                QMetaObject::invokeMethod(this, [this, entries, fullWindow, newestUsec]() {
+                    applyLiveEntries(entries, fullWindow, newestUsec);
                 }, Qt::QueuedConnection);
             }, Qt::QueuedConnection);
         });
 
+        // Push mode: the collector wakes on journal changes by itself
+        connect(m_liveCollector, &LogCollector::liveEntriesReady,
+                this, &MainWindow::applyLiveEntries, Qt::QueuedConnection);
+
         m_liveThread->start();
+        applyLiveMode();
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Live mode
+// ---------------------------------------------------------------------------
+
+void MainWindow::setLiveMode(LiveMode mode) {
+    if (mode == m_liveMode) return;
+    m_liveMode = mode;
+
+    // Latency figures are only comparable within one mode
+    m_liveLatencyLastMs  = 0;
+    m_liveLatencyTotalMs = 0;
+    m_liveLatencySamples = 0;
+    updateLiveTabTitle();
+
+    if (m_liveCollector) applyLiveMode();  // otherwise startCollections() does
+}
+
+void MainWindow::applyLiveMode() {
+    if (m_liveMode == LiveMode::Push) {
+        m_liveTab->stopLiveUpdates();
+        const int windowMinutes = m_liveWindowMinutes;
+        const int pollMs = m_livePollSeconds * 1000;
+        QMetaObject::invokeMethod(m_liveCollector, [this, windowMinutes, pollMs]() {
+            m_liveCollector->startLiveWatch(windowMinutes, pollMs);
+        }, Qt::QueuedConnection);
+    } else {
+        QMetaObject::invokeMethod(m_liveCollector, [this]() {
+            m_liveCollector->stopLiveWatch();
+        }, Qt::QueuedConnection);
         emit m_liveTab->needsRefresh();
         m_liveTab->startLiveUpdates(m_livePollSeconds * 1000);
+    }
+}
 
-        m_statusLabel->setText(QString("Ready · Scan: %1").arg(m_scanTab->entryCount()));
-    });
+void MainWindow::updateLiveTabTitle() {
+    const QString cadence = (m_liveMode == LiveMode::Push)
+        ? QString("push")
+        : QString("%1s poll").arg(m_livePollSeconds);
+    m_tabs->setTabText(m_tabs->indexOf(m_liveTab),
+                       QString("●  LIVE  —  %1min / %2").arg(m_liveWindowMinutes).arg(cadence));
+}
+
+void MainWindow::applyLiveEntries(const QVector<LogEntry>& entries, bool fullWindow,
+                                  qint64 newestEventUsec) {
+    // Push deliveries arrive at most once per collector frame and poll ones
+    // once per interval, so each is applied as it comes
+    if (fullWindow) {
+        m_liveTab->setData(entries);
+    } else {
+        const QDateTime cutoff = QDateTime::currentDateTimeUtc()
+                                     .addSecs(-m_liveWindowMinutes * 60);
+        m_liveTab->appendEntries(entries, cutoff);
+    }
+
+    // Event-to-screen latency: journal write time of the newest entry to the
+    // moment the tab has been updated. The priming delivery is skipped since
+    // its entries may be up to a full window old.
+    if (!fullWindow && newestEventUsec > 0) {
+        const qint64 nowUsec = QDateTime::currentMSecsSinceEpoch() * 1000;
+        m_liveLatencyLastMs   = qMax<qint64>(0, (nowUsec - newestEventUsec) / 1000);
+        m_liveLatencyTotalMs += m_liveLatencyLastMs;
+        ++m_liveLatencySamples;
+    }
+
+    QString status = QString("Live · %1 entries").arg(m_liveTab->entryCount());
+    if (m_liveLatencySamples > 0) {
+        status += QString(" · latency %1 ms (avg %2 ms, %3)")
+                      .arg(m_liveLatencyLastMs)
+                      .arg(m_liveLatencyTotalMs / m_liveLatencySamples)
+                      .arg(m_liveMode == LiveMode::Push ? "push" : "poll");
+    }
+    m_statusLabel->setText(status);
 }
 
 // ---------------------------------------------------------------------------
-// mergeAndDisplay
+// Streaming scan
 // ---------------------------------------------------------------------------
 
-void MainWindow::mergeAndDisplay(const QVector<LogEntry>& freshEntries) {
-    if (!m_persistence->isOpen()) {
-        // No persistence — just show fresh entries directly
-        m_scanTab->setData(freshEntries);
-        return;
+QString MainWindow::scanGapNote() const {
+    QString note;
+    if (m_lastScanStats.truncated) {
+        note += QString(" · capped at %1 journal entries, oldest omitted")
+                    .arg(m_lastScanStats.entriesKept);
     }
+    if (m_lastScanStats.kernelRecordsLost > 0) {
+        note += QString(" · %1 kernel records overwritten before they were read")
+                    .arg(m_lastScanStats.kernelRecordsLost);
+    }
+    return note;
+}
 
-    // Persist the new entries (upsert — duplicates are silently ignored)
-    m_persistence->upsertEvents(freshEntries);
+void MainWindow::startScan() {
+    // Snapshot the settings the scan thread needs; it must not read members
+    const int workers    = m_scanWorkers;
+    const QString dbPath = m_persistence->isOpen() ? m_persistence->currentPath() : QString();
+    const int ttlDays    = m_persistence->ttlDays();
+    // Without a store there is nothing to resume into
+    const ScanCheckpoint resume = m_persistence->isOpen()
+        ? m_persistence->loadScanCheckpoint() : ScanCheckpoint();
+
+    // Queued ahead of the scan itself, so it applies once any superseded
+    // scan has unwound
+    QMetaObject::invokeMethod(m_scanPersistence, [this, workers, dbPath, ttlDays, resume]() {
+        if (dbPath.isEmpty()) m_scanPersistence->close();
+        else if (!m_scanPersistence->isOpen() || m_scanPersistence->currentPath() != dbPath)
+            m_scanPersistence->open(dbPath);
+        m_scanPersistence->setTtlDays(ttlDays);
+        m_scanCollector->setScanWorkers(workers);
+        m_scanCollector->setResumeCheckpoint(resume);
+    }, Qt::QueuedConnection);
+
+    m_scanId           = m_scanCollector->requestScan(m_lookbackDays);
+    m_scanRunning      = true;
+    m_scanResuming     = false;  // until the collector reports scanStarted()
+    m_scanBatchEntries = 0;
+}
+
+void MainWindow::applyScanBatch(const QVector<LogEntry>& batch, quint64 scanId) {
+    if (scanId != m_scanId) return;  // left over from a superseded scan
+
+    if (m_scanResuming) {
+        // Only new entries arrive; the stored view stays until finishScan()
+        // reloads it with them merged in
+    } else if (m_scanBatchEntries == 0) {
+        // Fresh entries supersede the persisted preview shown at startup
+        m_scanTab->setData(batch);
+    } else {
+        m_scanTab->appendOlderEntries(batch);
+    }
+    m_scanBatchEntries += batch.size();
+
+    m_statusLabel->setText(QString("Scanning… %1 entries").arg(m_scanBatchEntries));
+}
 
-    // Load the full non-expired set from the DB (this naturally includes
-    // both the freshly inserted events and all previously stored events).
-    // Because every event has a unique fingerprint and we upserted before
-    // loading, there are no duplicates in this result set.
-    const auto merged = m_persistence->loadActiveEvents();
-    m_scanTab->setData(merged);
+void MainWindow::finishScan(quint64 scanId, const QVector<LogEntry>& activeEvents,
+                            const JournalScanStats& stats, const QVector<JournalBoot>& boots) {
+    if (scanId != m_scanId) return;
+
+    qDebug() << "Scan collected:" << m_scanBatchEntries << "entries";
+    const ThreatCacheStats cache = ThreatDetector::current()->cacheStats();
+    qDebug() << "Threat cache:" << cache.hits << "hits," << cache.misses << "misses,"
+             << cache.size << "/" << cache.capacity << "entries";
+    m_scanRunning   = false;
+    m_lastScanStats = stats;
+    m_scanTab->setBoots(boots);
+
+    // Without persistence the streamed batches are already the whole view
+    if (m_persistence->isOpen()) m_scanTab->setData(activeEvents);
+    else if (m_scanBatchEntries == 0) m_scanTab->setData({});
+
+    m_statusLabel->setText(QString("Ready · Scan: %1%2")
+                           .arg(m_scanTab->entryCount())
+                           .arg(scanGapNote()));
+    m_tabs->setTabText(0, QString("◉  SCAN  —  %1d historical").arg(m_lookbackDays));
 }
 
 // ---------------------------------------------------------------------------
@@ -5,12 +5,14 @@
 #include "logcollector.h"
 #include "persistencemanager.h"
 #include "settingsdrawer.h"
+#include "threatrulewatcher.h"
 #include <QMainWindow>
 #include <QTabWidget>
 #include <QLabel>
 #include <QThread>
 #include <QSpinBox>
 #include <QPushButton>
+#include <QComboBox>
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -41,26 +43,69 @@ private:
     int m_lookbackDays;
     int m_liveWindowMinutes;
     int m_livePollSeconds;
+    int m_scanWorkers = QThread::idealThreadCount(); // time shards for the historical scan
+
+    // Poll re-collects on m_liveTab's timer; Push wakes on journal changes
+    enum class LiveMode { Poll, Push };
+    LiveMode m_liveMode = LiveMode::Push;
+
+    // Event-to-screen latency of live deliveries in the current mode
+    qint64 m_liveLatencyLastMs  = 0;
+    qint64 m_liveLatencyTotalMs = 0;
+    int    m_liveLatencySamples = 0;
 
     QTabWidget* m_tabs;
     StatsTab*   m_scanTab;
     StatsTab*   m_liveTab;
     QLabel*     m_statusLabel;
 
-    LogCollector* m_scanCollector;
-    LogCollector* m_liveCollector;
+    LogCollector* m_scanCollector = nullptr;
+    bool          m_scanRunning      = false;
+    bool          m_scanResuming     = false; // resuming from a stored checkpoint
+    quint64       m_scanId           = 0; // current scan; batches of older ones are dropped
+    int           m_scanBatchEntries = 0; // entries streamed by the running scan
+    JournalScanStats m_lastScanStats;
+    // Only touched on m_scanThread, by the handlers that upsert batches
+    int           m_scanStreamed     = 0;
+    int           m_scanNewEvents    = 0;
+    LogCollector* m_liveCollector = nullptr;
     QThread*      m_scanThread;
     QThread*      m_liveThread;
 
     PersistenceManager* m_persistence;
+    // Second connection to the same DB, owned by m_scanThread (a
+    // QSqlDatabase connection may only be used on the thread that made it)
+    PersistenceManager* m_scanPersistence = nullptr;
     SettingsDrawer*     m_settingsDrawer;
+    ThreatRuleWatcher*  m_ruleWatcher;
 
     void setupUI();
 
-    // Merged view: persisted events + freshly-scanned events, no duplicates.
-    // The fingerprint set is used to deduplicate; fresh entries that already
-    // exist in the DB are not double-shown.
-    void mergeAndDisplay(const QVector<LogEntry>& freshEntries);
+    void setLiveMode(LiveMode mode);
+    void applyLiveMode();  // starts the current mode, stopping the other
+    void updateLiveTabTitle();
+
+    // Applies a live delivery (from either mode) to the live tab and records
+    // the event-to-screen latency of the newest journal entry in it.
+    void applyLiveEntries(const QVector<LogEntry>& entries, bool fullWindow,
+                          qint64 newestEventUsec);
+
+    // Streaming scan. The first batch replaces the persisted preview; each
+    // batch is shown and upserted as it arrives. When the scan completes the
+    // tab is reloaded from the DB so persisted events older than the scan
+    // window are merged back in (deduplicated by fingerprint).
+    // The scan, threat detection and the upsert all run on m_scanThread;
+    // batches, the final active set and the journal's boot index come back
+    // as queued calls. Starting a scan while one is running cancels the old
+    // one.
+    void startScan();
+    void applyScanBatch(const QVector<LogEntry>& batch, quint64 scanId);
+    void finishScan(quint64 scanId, const QVector<LogEntry>& activeEvents,
+                    const JournalScanStats& stats, const QVector<JournalBoot>& boots);
+
+    // Status-bar suffix warning that the last scan hit the journal entry cap
+    // or found kernel records overwritten since its checkpoint
+    QString scanGapNote() const;
 
     // Default XDG-compliant DB path (~/.local/share/error-dashboard/events.db)
     static QString defaultDbPath();
@@ -0,0 +1,48 @@
+#ifndef PARALLELBATCH_H
+#define PARALLELBATCH_H
+
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <atomic>
+
+// Calls fn on every element of [begin, end), spread over up to workers
+// threads (0 = QThread::idealThreadCount()). The range is cut into runs of
+// chunk consecutive elements that threads claim from a shared counter until
+// none are left, so a thread stuck on slow elements does not hold up the
+// rest. The calling thread claims runs too; helpers come from the global
+// QThreadPool and only idle pool threads are used, so a busy pool never
+// makes the call wait. fn must be safe to call concurrently on distinct
+// elements.
+template <typename T, typename Fn>
+void forEachParallel(T* begin, T* end, int chunk, int workers, Fn fn) {
+    chunk = std::max(1, chunk);
+    const qint64 chunks = (qint64(end - begin) + chunk - 1) / chunk;
+    if (workers <= 0) workers = QThread::idealThreadCount();
+    const int wanted = int(std::min<qint64>(workers, chunks)) - 1;
+    if (wanted <= 0) {
+        for (T* item = begin; item != end; ++item) fn(*item);
+        return;
+    }
+
+    std::atomic<qint64> nextChunk{0};
+    auto drain = [&]() {
+        qint64 run;
+        while ((run = nextChunk.fetch_add(1, std::memory_order_relaxed)) < chunks) {
+            T* item = begin + run * chunk;
+            T* const last = std::min(item + chunk, end);
+            for (; item != last; ++item) fn(*item);
+        }
+    };
+
+    QSemaphore finished;
+    int helpers = 0;
+    QThreadPool* pool = QThreadPool::globalInstance();
+    while (helpers < wanted && pool->tryStart([&]() { drain(); finished.release(); }))
+        ++helpers;
+    drain();
+    finished.acquire(helpers);
+}
+
+#endif // PARALLELBATCH_H
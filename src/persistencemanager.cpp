@@ -1,8 +1,12 @@
 #include "persistencemanager.h"
+#include "entityextractor.h"
+#include "templateminer.h"
 #include <QtSql/QSqlQuery>
 #include <QtSql/QSqlError>
 #include <QCryptographicHash>
 #include <QFileInfo>
+#include <QHash>
+#include <QSet>
 #include <QDebug>
 
 PersistenceManager::PersistenceManager(QObject* parent)
@@ -48,6 +52,9 @@ bool PersistenceManager::open(const QString& path) {
         return false;
     }
 
+    // Stored template ids keep meaning the same shapes in new scans
+    TemplateMiner::shared().restore(loadTemplates());
+
     emit databaseOpened(path);
     return true;
 }
@@ -79,7 +86,9 @@ bool PersistenceManager::createSchema() {
     QSqlQuery q(m_db);
 
     // log_events — one row per unique log occurrence.
-    // fingerprint is the SHA256 of (event_timestamp_usec + unit + message).
+    // fingerprint is the SHA256 of (event_timestamp + unit + message).
+    // event_timestamp is whole seconds (fingerprint/TTL); event_timestamp_usec
+    // carries the full-resolution time used for ordering.
     // expires_at is set at INSERT time using the TTL that was active when
     // the event was first recorded; changing TTL later does NOT retroactively
     // alter this column.
@@ -87,6 +96,7 @@ bool PersistenceManager::createSchema() {
         CREATE TABLE IF NOT EXISTS log_events (
             fingerprint     TEXT    PRIMARY KEY,
             event_timestamp INTEGER NOT NULL,
+            event_timestamp_usec INTEGER,
             expires_at      INTEGER NOT NULL,
             source          TEXT,
             grp             TEXT,
@@ -103,7 +113,8 @@ bool PersistenceManager::createSchema() {
             cursor_id       TEXT,
             threat_count    INTEGER DEFAULT 0,
             max_threat_sev  TEXT,
-            threat_json     TEXT
+            threat_json     TEXT,
+            template_id     INTEGER DEFAULT 0
         )
     )");
 
@@ -114,11 +125,58 @@ bool PersistenceManager::createSchema() {
         return false;
     }
 
+    // Databases created before event_timestamp_usec existed: add the column
+    // and backfill it from the second-resolution timestamp.
+    bool hasUsec = false;
+    bool hasTemplate = false;
+    q.exec("PRAGMA table_info(log_events)");
+    while (q.next()) {
+        if (q.value(1).toString() == "event_timestamp_usec") hasUsec = true;
+        if (q.value(1).toString() == "template_id") hasTemplate = true;
+    }
+    if (!hasUsec) {
+        q.exec("ALTER TABLE log_events ADD COLUMN event_timestamp_usec INTEGER");
+        q.exec("UPDATE log_events SET event_timestamp_usec = event_timestamp * 1000000");
+    }
+    // Older rows are mined as they are loaded
+    if (!hasTemplate) q.exec("ALTER TABLE log_events ADD COLUMN template_id INTEGER DEFAULT 0");
+
     // Indexes for the most common query patterns
     q.exec("CREATE INDEX IF NOT EXISTS idx_expires   ON log_events(expires_at)");
     q.exec("CREATE INDEX IF NOT EXISTS idx_timestamp ON log_events(event_timestamp DESC)");
+    q.exec("CREATE INDEX IF NOT EXISTS idx_timestamp_usec ON log_events(event_timestamp_usec DESC)");
     q.exec("CREATE INDEX IF NOT EXISTS idx_grp       ON log_events(grp)");
     q.exec("CREATE INDEX IF NOT EXISTS idx_unit      ON log_events(unit)");
+    q.exec("CREATE INDEX IF NOT EXISTS idx_template  ON log_events(template_id)");
+
+    // log_templates — the TemplateMiner pattern behind each template_id.
+    // Rewritten as patterns generalise; ids never change meaning.
+    q.exec(R"(
+        CREATE TABLE IF NOT EXISTS log_templates (
+            id              INTEGER PRIMARY KEY,
+            pattern         TEXT    NOT NULL
+        )
+    )");
+
+    // log_entities — inverted index from an extracted entity (LogEntity)
+    // to the events naming it. The primary key keeps each entity's
+    // fingerprints sorted and together; rows go with their event through
+    // the foreign key, so purge and clear need no extra work.
+    bool hasEntities = false;
+    q.exec("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'log_entities'");
+    if (q.next()) hasEntities = true;
+    q.exec(R"(
+        CREATE TABLE IF NOT EXISTS log_entities (
+            kind            INTEGER NOT NULL,
+            value           TEXT    NOT NULL,
+            fingerprint     TEXT    NOT NULL
+                            REFERENCES log_events(fingerprint) ON DELETE CASCADE,
+            PRIMARY KEY (kind, value, fingerprint)
+        ) WITHOUT ROWID
+    )");
+    q.exec("CREATE INDEX IF NOT EXISTS idx_entity_fp ON log_entities(fingerprint)");
+    // Databases created before the index existed: extract from what is stored
+    if (!hasEntities) backfillEntities();
 
     // scan_runs — audit trail of every collection run
     q.exec(R"(
@@ -130,6 +188,19 @@ bool PersistenceManager::createSchema() {
         )
     )");
 
+    // scan_checkpoints — where the last completed scan got to, per source.
+    // position is a journal cursor or a kmsg sequence number; scope is what
+    // it is only valid under (journal filters, kmsg boot id).
+    q.exec(R"(
+        CREATE TABLE IF NOT EXISTS scan_checkpoints (
+            source          TEXT    PRIMARY KEY,
+            position        TEXT    NOT NULL,
+            scope           TEXT,
+            covered_from    INTEGER DEFAULT 0,
+            updated_at      INTEGER NOT NULL
+        )
+    )");
+
     return true;
 }
 
@@ -155,7 +226,7 @@ QString PersistenceManager::computeFingerprint(const LogEntry& entry) {
     // This means the same log line seen in two overlapping scans produces the
     // same hash and will be skipped on the second insert (idempotent upsert).
     const QString raw = QString("%1|%2|%3")
-        .arg(entry.timestamp.toSecsSinceEpoch())
+        .arg(entry.timestampUsec / 1000000)
         .arg(entry.unit)
         .arg(entry.message);
 
@@ -185,8 +256,18 @@ static QString threatJsonSerialize(const QVector<ThreatMatch>& threats) {
 bool PersistenceManager::upsertEvent(const LogEntry& entry) {
     if (!m_db.isOpen()) return false;
 
+    const bool inserted = insertEvent(entry);
+    saveTemplates({entry.templateId});
+    return inserted;
+}
+
+bool PersistenceManager::insertEvent(const LogEntry& entry) {
+    // Burst state is not saved, so a resumed scan can complete a burst the
+    // stored one already reported, on a different trigger line
+    if (entry.source == "correlation" && hasCorrelatedEvent(entry)) return false;
+
     const QString fp      = computeFingerprint(entry);
-    const qint64  evTs    = entry.timestamp.toSecsSinceEpoch();
+    const qint64  evTs    = entry.timestampUsec / 1000000;
     const qint64  expires = evTs + (static_cast<qint64>(m_ttlDays) * 86400);
 
     // INSERT OR IGNORE — if fingerprint already exists (duplicate scan window
@@ -194,17 +275,18 @@ bool PersistenceManager::upsertEvent(const LogEntry& entry) {
     QSqlQuery q(m_db);
     q.prepare(R"(
         INSERT OR IGNORE INTO log_events
-            (fingerprint, event_timestamp, expires_at, source, grp, priority,
+            (fingerprint, event_timestamp, event_timestamp_usec, expires_at, source, grp, priority,
              unit, pid, exe, cmdline, hostname, boot_id, message, message_id,
-             transport, cursor_id, threat_count, max_threat_sev, threat_json)
+             transport, cursor_id, threat_count, max_threat_sev, threat_json, template_id)
         VALUES
-            (:fp, :evts, :exp, :src, :grp, :prio,
+            (:fp, :evts, :evus, :exp, :src, :grp, :prio,
              :unit, :pid, :exe, :cmd, :host, :boot, :msg, :msgid,
-             :trans, :cursor, :tc, :mts, :tj)
+             :trans, :cursor, :tc, :mts, :tj, :tpl)
     )");
 
     q.bindValue(":fp",     fp);
     q.bindValue(":evts",   evTs);
+    q.bindValue(":evus",   entry.timestampUsec);
     q.bindValue(":exp",    expires);
     q.bindValue(":src",    entry.source);
     q.bindValue(":grp",    entry.group);
@@ -222,6 +304,7 @@ bool PersistenceManager::upsertEvent(const LogEntry& entry) {
     q.bindValue(":tc",     entry.threatCount);
     q.bindValue(":mts",    entry.maxThreatSeverity);
     q.bindValue(":tj",     threatJsonSerialize(entry.threats));
+    q.bindValue(":tpl",    entry.templateId);
 
     if (!q.exec()) {
         qWarning() << "PersistenceManager: insert failed:" << q.lastError().text();
@@ -230,10 +313,55 @@ bool PersistenceManager::upsertEvent(const LogEntry& entry) {
 
     // numRowsAffected() == 1 means a new row was inserted;
     // 0 means the fingerprint already existed (ignored).
-    return q.numRowsAffected() == 1;
+    if (q.numRowsAffected() != 1) return false;
+
+    insertEntities(fp, entry.entities);
+    return true;
 }
 
-int PersistenceManager::upsertEvents(const QVector<LogEntry>& entries) {
+bool PersistenceManager::hasCorrelatedEvent(const LogEntry& entry) const {
+    // The cursor is "correlation:<rule>:<window usec>:<key>"
+    const qint64 windowUsec = entry.cursor.section(':', 2, 2).toLongLong();
+    if (windowUsec <= 0) return false;
+
+    QSqlQuery q(m_db);
+    q.prepare(R"(
+        SELECT 1 FROM log_events
+        WHERE event_timestamp_usec BETWEEN :from AND :to AND cursor_id = :cursor
+        LIMIT 1
+    )");
+    q.bindValue(":from",   entry.timestampUsec - windowUsec);
+    q.bindValue(":to",     entry.timestampUsec + windowUsec);
+    q.bindValue(":cursor", entry.cursor);
+    return q.exec() && q.next();
+}
+
+void PersistenceManager::insertEntities(const QString& fingerprint,
+                                        const QVector<LogEntity>& entities) {
+    if (entities.isEmpty()) return;
+
+    QSqlQuery q(m_db);
+    q.prepare("INSERT OR IGNORE INTO log_entities (kind, value, fingerprint) VALUES (:kind, :value, :fp)");
+    for (const auto& entity : entities) {
+        q.bindValue(":kind",  int(entity.kind));
+        q.bindValue(":value", entity.value);
+        q.bindValue(":fp",    fingerprint);
+        if (!q.exec())
+            qWarning() << "PersistenceManager: entity insert failed:" << q.lastError().text();
+    }
+}
+
+void PersistenceManager::backfillEntities() {
+    QSqlQuery q(m_db);
+    if (!q.exec("SELECT fingerprint, message FROM log_events")) return;
+
+    m_db.transaction();
+    while (q.next())
+        insertEntities(q.value(0).toString(), EntityExtractor::extract(q.value(1).toString()));
+    m_db.commit();
+}
+
+int PersistenceManager::upsertEvents(const QVector<LogEntry>& entries, bool recordRun) {
     if (!m_db.isOpen() || entries.isEmpty()) return 0;
 
     int newCount = 0;
@@ -241,17 +369,49 @@ int PersistenceManager::upsertEvents(const QVector<LogEntry>& entries) {
     // Wrap the entire batch in a single transaction — dramatically faster
     // than auto-committing each INSERT individually.
     m_db.transaction();
+    QSet<quint32> templateIds;
     for (const auto& entry : entries) {
-        if (upsertEvent(entry)) ++newCount;
+        if (insertEvent(entry)) ++newCount;
+        templateIds.insert(entry.templateId);
     }
+    saveTemplates(templateIds);
     m_db.commit();
 
     // Record the run in the audit table
-    recordScanRun(newCount, entries.size() - newCount);
+    if (recordRun) recordScanRun(newCount, entries.size() - newCount);
 
     return newCount;
 }
 
+void PersistenceManager::saveTemplates(const QSet<quint32>& ids) {
+    QSqlQuery q(m_db);
+    q.prepare("INSERT OR REPLACE INTO log_templates (id, pattern) VALUES (:id, :pattern)");
+    for (const quint32 id : ids) {
+        if (id == 0) continue;
+        const LogTemplate tpl = TemplateMiner::shared().find(id);
+        if (tpl.id == 0) continue;
+        q.bindValue(":id",      tpl.id);
+        q.bindValue(":pattern", tpl.pattern);
+        if (!q.exec())
+            qWarning() << "PersistenceManager: template save failed:" << q.lastError().text();
+    }
+}
+
+QVector<LogTemplate> PersistenceManager::loadTemplates() const {
+    QVector<LogTemplate> templates;
+    if (!m_db.isOpen()) return templates;
+
+    QSqlQuery q(m_db);
+    if (!q.exec("SELECT id, pattern FROM log_templates ORDER BY id")) return templates;
+    while (q.next()) {
+        LogTemplate tpl;
+        tpl.id      = q.value(0).toUInt();
+        tpl.pattern = q.value(1).toString();
+        templates.append(tpl);
+    }
+    return templates;
+}
+
 bool PersistenceManager::recordScanRun(int newEvents, int /*updatedEvents*/) {
     QSqlQuery q(m_db);
     q.prepare("INSERT INTO scan_runs (run_at, new_events) VALUES (:ts, :ne)");
@@ -260,6 +420,69 @@ bool PersistenceManager::recordScanRun(int newEvents, int /*updatedEvents*/) {
     return q.exec();
 }
 
+// ---------------------------------------------------------------------------
+// Scan checkpoint
+// ---------------------------------------------------------------------------
+
+bool PersistenceManager::saveScanCheckpoint(const ScanCheckpoint& checkpoint) {
+    if (!m_db.isOpen()) return false;
+
+    const qint64 now = QDateTime::currentDateTimeUtc().toSecsSinceEpoch();
+    m_db.transaction();
+    QSqlQuery q(m_db);
+    bool ok = q.exec("DELETE FROM scan_checkpoints");
+
+    q.prepare(R"(
+        INSERT INTO scan_checkpoints (source, position, scope, covered_from, updated_at)
+        VALUES (:src, :pos, :scope, :from, :now)
+    )");
+    if (ok && !checkpoint.journalCursor.isEmpty()) {
+        q.bindValue(":src",   "journal");
+        q.bindValue(":pos",   checkpoint.journalCursor);
+        q.bindValue(":scope", checkpoint.journalScope);
+        q.bindValue(":from",  checkpoint.coveredFromUsec);
+        q.bindValue(":now",   now);
+        ok = q.exec();
+    }
+    if (ok && checkpoint.kmsgSequence > 0) {
+        q.bindValue(":src",   "kmsg");
+        q.bindValue(":pos",   QString::number(checkpoint.kmsgSequence));
+        q.bindValue(":scope", checkpoint.kmsgBootId);
+        q.bindValue(":from",  0);
+        q.bindValue(":now",   now);
+        ok = q.exec();
+    }
+
+    if (!ok) {
+        qWarning() << "PersistenceManager: checkpoint save failed:" << q.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+    return m_db.commit();
+}
+
+ScanCheckpoint PersistenceManager::loadScanCheckpoint() const {
+    ScanCheckpoint checkpoint;
+    if (!m_db.isOpen()) return checkpoint;
+
+    QSqlQuery q(m_db);
+    if (!q.exec("SELECT source, position, scope, covered_from FROM scan_checkpoints"))
+        return checkpoint;
+
+    while (q.next()) {
+        const QString source = q.value(0).toString();
+        if (source == "journal") {
+            checkpoint.journalCursor   = q.value(1).toString();
+            checkpoint.journalScope    = q.value(2).toString();
+            checkpoint.coveredFromUsec = q.value(3).toLongLong();
+        } else if (source == "kmsg") {
+            checkpoint.kmsgSequence = q.value(1).toString().toULongLong();
+            checkpoint.kmsgBootId   = q.value(2).toString();
+        }
+    }
+    return checkpoint;
+}
+
 // ---------------------------------------------------------------------------
 // Read path
 // ---------------------------------------------------------------------------
@@ -303,13 +526,13 @@ QVector<LogEntry> PersistenceManager::loadActiveEvents() const {
 
     QSqlQuery q(m_db);
     q.prepare(R"(
-        SELECT fingerprint, event_timestamp, source, grp, priority,
+        SELECT fingerprint, event_timestamp_usec, source, grp, priority,
                unit, pid, exe, cmdline, hostname, boot_id, message,
                message_id, transport, cursor_id, threat_count, max_threat_sev,
-               threat_json
+               threat_json, template_id
         FROM log_events
         WHERE expires_at > :now
-        ORDER BY event_timestamp DESC
+        ORDER BY event_timestamp_usec DESC
     )");
     q.bindValue(":now", now);
 
@@ -321,7 +544,7 @@ QVector<LogEntry> PersistenceManager::loadActiveEvents() const {
     while (q.next()) {
         LogEntry e;
         e.cursor          = q.value(0).toString();  // fingerprint stored as cursor surrogate for display
-        e.timestamp       = QDateTime::fromSecsSinceEpoch(q.value(1).toLongLong(), Qt::UTC);
+        e.timestampUsec   = q.value(1).toLongLong();
         e.source          = q.value(2).toString();
         e.group           = q.value(3).toString();
         e.priority        = q.value(4).toInt();
@@ -339,12 +562,57 @@ QVector<LogEntry> PersistenceManager::loadActiveEvents() const {
         e.threatCount         = q.value(15).toInt();
         e.maxThreatSeverity   = q.value(16).toString();
         e.threats             = threatJsonDeserialize(q.value(17).toString());
+        e.templateId          = q.value(18).toUInt();
+        if (e.templateId == 0) TemplateMiner::shared().annotate(e);
         entries.append(e);
     }
 
+    QHash<QString, int> rows;
+    rows.reserve(entries.size());
+    for (int i = 0; i < entries.size(); ++i) rows.insert(entries[i].cursor, i);
+
+    q.prepare(R"(
+        SELECT n.fingerprint, n.kind, n.value
+        FROM log_entities n JOIN log_events e ON e.fingerprint = n.fingerprint
+        WHERE e.expires_at > :now
+    )");
+    q.bindValue(":now", now);
+    if (!q.exec()) {
+        qWarning() << "PersistenceManager: entity load failed:" << q.lastError().text();
+        return entries;
+    }
+    while (q.next()) {
+        const auto row = rows.constFind(q.value(0).toString());
+        if (row == rows.constEnd()) continue;
+        entries[row.value()].entities.append(
+            LogEntity{LogEntity::Kind(q.value(1).toInt()), q.value(2).toString()});
+    }
+
     return entries;
 }
 
+QStringList PersistenceManager::fingerprintsWithEntity(const LogEntity& entity) const {
+    QStringList fingerprints;
+    if (!m_db.isOpen()) return fingerprints;
+
+    QSqlQuery q(m_db);
+    q.prepare(R"(
+        SELECT n.fingerprint
+        FROM log_entities n JOIN log_events e ON e.fingerprint = n.fingerprint
+        WHERE n.kind = :kind AND n.value = :value AND e.expires_at > :now
+        ORDER BY n.fingerprint
+    )");
+    q.bindValue(":kind",  int(entity.kind));
+    q.bindValue(":value", entity.value);
+    q.bindValue(":now",   QDateTime::currentDateTimeUtc().toSecsSinceEpoch());
+    if (!q.exec()) {
+        qWarning() << "PersistenceManager: entity lookup failed:" << q.lastError().text();
+        return fingerprints;
+    }
+    while (q.next()) fingerprints.append(q.value(0).toString());
+    return fingerprints;
+}
+
 // ---------------------------------------------------------------------------
 // Maintenance
 // ---------------------------------------------------------------------------
@@ -364,6 +632,9 @@ int PersistenceManager::purgeExpired() {
 
     const int removed = q.numRowsAffected();
     if (removed > 0) {
+        // Only the rows go: live entries and batches not yet stored may
+        // still carry these ids, and saving them later re-inserts the row
+        q.exec("DELETE FROM log_templates WHERE id NOT IN (SELECT template_id FROM log_events)");
         q.exec("VACUUM");
         emit purgeComplete(removed);
     }
@@ -374,7 +645,9 @@ bool PersistenceManager::clearAll() {
     if (!m_db.isOpen()) return false;
 
     QSqlQuery q(m_db);
-    const bool ok = q.exec("DELETE FROM log_events") && q.exec("DELETE FROM scan_runs");
+    // The checkpoint goes too, or the next scan would skip what was deleted
+    const bool ok = q.exec("DELETE FROM log_events") && q.exec("DELETE FROM scan_runs")
+                 && q.exec("DELETE FROM scan_checkpoints") && q.exec("DELETE FROM log_templates");
     if (ok) q.exec("VACUUM");
     return ok;
 }
@@ -2,9 +2,12 @@
 #define PERSISTENCEMANAGER_H
 
 #include "logentry.h"
+#include "templateminer.h"
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QDateTime>
+#include <QSet>
 #include <QVector>
 #include <QtSql/QSqlDatabase>
 
@@ -39,10 +42,24 @@ public:
 
     // Write path — upsert based on fingerprint. Returns true if new record inserted.
     bool upsertEvent(const LogEntry& entry);
-    int upsertEvents(const QVector<LogEntry>& entries);
+    // recordRun = false lets a streamed scan upsert batch by batch and call
+    // recordScanRun() once at the end.
+    int upsertEvents(const QVector<LogEntry>& entries, bool recordRun = true);
+    bool recordScanRun(int newEvents, int updatedEvents);
 
-    // Read path — returns all non-expired events
+    // Read path — returns all non-expired events, entities included
     QVector<LogEntry> loadActiveEvents() const;
+    // Fingerprints (sorted) of the non-expired events naming entity
+    QStringList fingerprintsWithEntity(const LogEntity& entity) const;
+    // Patterns behind the stored template ids (counts are not stored);
+    // open() restores them into TemplateMiner::shared()
+    QVector<LogTemplate> loadTemplates() const;
+
+    // Scan checkpoint — one row per source (journal, kmsg) in
+    // scan_checkpoints. Saving replaces the previous one; an empty
+    // checkpoint is returned when none is stored.
+    bool saveScanCheckpoint(const ScanCheckpoint& checkpoint);
+    ScanCheckpoint loadScanCheckpoint() const;
 
     // Maintenance
     int purgeExpired();
@@ -58,7 +75,14 @@ signals:
 
 private:
     bool createSchema();
-    bool recordScanRun(int newEvents, int updatedEvents);
+    bool insertEvent(const LogEntry& entry);
+    // True when a correlated event of the same rule and key is stored
+    // within the rule's window of entry (see CorrelationEngine)
+    bool hasCorrelatedEvent(const LogEntry& entry) const;
+    // Writes the current pattern of each template id
+    void saveTemplates(const QSet<quint32>& ids);
+    void insertEntities(const QString& fingerprint, const QVector<LogEntity>& entities);
+    void backfillEntities();
     QSqlDatabase m_db;
     QString m_path;
     int m_ttlDays = 30;
@@ -1,10 +1,12 @@
 #include "statstab.h"
+#include "templateminer.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
 #include <QHeaderView>
 #include <QFileDialog>
 #include <QTextStream>
+#include <QUrl>
 #include <QEvent>
 #include <QMouseEvent>
 #include <QtCharts/QBarSeries>
@@ -16,10 +18,18 @@
 #include <QtCharts/QValueAxis>
 
 StatsTab::StatsTab(const QString& mode, QWidget* parent)
-    : QWidget(parent), m_mode(mode), m_refreshTimer(new QTimer(this))
+    : QWidget(parent), m_mode(mode), m_refreshTimer(new QTimer(this)),
+      m_redrawTimer(new QTimer(this))
 {
     setupUI();
     connect(m_refreshTimer, &QTimer::timeout, this, &StatsTab::needsRefresh);
+
+    m_redrawTimer->setSingleShot(true);
+    m_redrawTimer->setInterval(250);
+    connect(m_redrawTimer, &QTimer::timeout, this, [this]() {
+        updateCharts();
+        if (m_templatesToggle->isChecked()) updateTemplateTable();
+    });
 }
 
 void StatsTab::setupUI() {
@@ -94,7 +104,7 @@ void StatsTab::setupUI() {
             padding: 5px 12px;
             border-radius: 6px;
         }
-        QPushButton:hover {
+        QPushButton:hover, QPushButton:checked {
             border-color: #7B61FF;
             color: #7B61FF;
         }
@@ -119,6 +129,7 @@ void StatsTab::setupUI() {
 
     createTable();
     mainLayout->addWidget(m_table);
+    mainLayout->addWidget(m_templateTable);
 }
 
 // ---------------------------------------------------------------------------
@@ -277,15 +288,38 @@ QHBoxLayout* StatsTab::createFilters() {
     layout->addWidget(unitLabel);
 
     m_unitFilter = new QComboBox();
+    m_unitFilter->setObjectName("unitFilter");
     m_unitFilter->addItem("All units", "all");
     m_unitFilter->setMinimumWidth(220);
     connect(m_unitFilter, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &StatsTab::onFilterChanged);
     layout->addWidget(m_unitFilter);
 
+    auto* bootSeparator = new QLabel(" | ");
+    layout->addWidget(bootSeparator);
+    auto* bootLabel = new QLabel("Boot:");
+    bootLabel->setStyleSheet("font-size: 10px; color: #555;");
+    layout->addWidget(bootLabel);
+
+    m_bootFilter = new QComboBox();
+    m_bootFilter->setObjectName("bootFilter");
+    m_bootFilter->addItem("All boots", "all");
+    m_bootFilter->setMinimumWidth(260);
+    connect(m_bootFilter, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &StatsTab::onBootChanged);
+    layout->addWidget(m_bootFilter);
+
+    // The live window rarely spans a reboot
+    if (m_mode == "live") {
+        for (QWidget* w : {static_cast<QWidget*>(bootSeparator), static_cast<QWidget*>(bootLabel),
+                           static_cast<QWidget*>(m_bootFilter)})
+            w->setVisible(false);
+    }
+
     layout->addWidget(new QLabel(" | "));
     m_searchBox = new QLineEdit();
-    m_searchBox->setPlaceholderText("Search message, unit, exe…");
+    m_searchBox->setObjectName("searchBox");
+    m_searchBox->setPlaceholderText("Search message, unit, exe… or ip:/user:/port:/template:");
     m_searchBox->setMinimumWidth(280);
     connect(m_searchBox, &QLineEdit::textChanged, this, &StatsTab::onFilterChanged);
     layout->addWidget(m_searchBox);
@@ -296,6 +330,13 @@ QHBoxLayout* StatsTab::createFilters() {
     m_rowCountLabel->setStyleSheet("font-size: 11px; color: #555;");
     layout->addWidget(m_rowCountLabel);
 
+    m_templatesToggle = new QPushButton("▤ Templates");
+    m_templatesToggle->setObjectName("templatesToggle");
+    m_templatesToggle->setCheckable(true);
+    m_templatesToggle->setToolTip("Collapse rows into message templates");
+    connect(m_templatesToggle, &QPushButton::toggled, this, &StatsTab::onTemplatesToggled);
+    layout->addWidget(m_templatesToggle);
+
     auto* exportBtn = new QPushButton("⬇ Export CSV");
     connect(exportBtn, &QPushButton::clicked, this, &StatsTab::onExportCSV);
     layout->addWidget(exportBtn);
@@ -334,6 +375,25 @@ void StatsTab::createTable() {
     m_table->setColumnWidth(9,   75);
 
     connect(m_table, &QTableWidget::cellClicked, this, &StatsTab::onRowClicked);
+
+    m_templateTable = new QTableWidget();
+    m_templateTable->setObjectName("templateTable");
+    m_templateTable->setColumnCount(5);
+    m_templateTable->setHorizontalHeaderLabels({
+        "Count", "First Seen", "Last Seen", "ID", "Template"
+    });
+    m_templateTable->horizontalHeader()->setStretchLastSection(true);
+    m_templateTable->verticalHeader()->setVisible(false);
+    m_templateTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_templateTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_templateTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_templateTable->setColumnWidth(0,  80);
+    m_templateTable->setColumnWidth(1, 165);
+    m_templateTable->setColumnWidth(2, 165);
+    m_templateTable->setColumnWidth(3,  60);
+    m_templateTable->setVisible(false);
+
+    connect(m_templateTable, &QTableWidget::cellClicked, this, &StatsTab::onTemplateClicked);
 }
 
 // ---------------------------------------------------------------------------
@@ -365,8 +425,11 @@ void StatsTab::createDetailPanel() {
 
     layout->addLayout(header);
 
-    m_detailContent = new QTextEdit();
-    m_detailContent->setReadOnly(true);
+    m_detailContent = new QTextBrowser();
+    m_detailContent->setObjectName("detailContent");
+    // Entity links filter the table instead of navigating
+    m_detailContent->setOpenLinks(false);
+    connect(m_detailContent, &QTextBrowser::anchorClicked, this, &StatsTab::onEntityClicked);
     m_detailContent->setStyleSheet(R"(
         background: #0a0a10;
         border: 1px solid #22222e;
@@ -384,49 +447,273 @@ void StatsTab::createDetailPanel() {
 
 void StatsTab::setData(const QVector<LogEntry>& entries) {
     m_allEntries = entries;
+    rebuildIndexes();
+    updateBootFilter();
     updateStats();
     updateCharts();
     updateUnitFilter();
     applyFilters();
 }
 
-void StatsTab::updateStats() {
-    int critical = 0, error = 0, warning = 0, threats = 0;
-    for (const auto& entry : m_allEntries) {
-        if      (entry.group == "critical") critical++;
-        else if (entry.group == "error")    error++;
-        else if (entry.group == "warning")  warning++;
-        threats += entry.threatCount;
+void StatsTab::appendEntries(const QVector<LogEntry>& newEntries, const QDateTime& evictBefore) {
+    // m_allEntries is newest-first, so expired entries sit at the tail
+    const qint64 evictUsec = evictBefore.toMSecsSinceEpoch() * 1000;
+    bool bootsChanged = false;
+    bool unitsChanged = false;
+    int evicted = 0;
+    while (!m_allEntries.isEmpty() && m_allEntries.last().timestampUsec < evictUsec) {
+        const LogEntry& oldest = m_allEntries.last();
+        bootsChanged |= unindexOldestRow(oldest);
+        unitsChanged |= m_totals.add(oldest, bucketUsec(), -1);
+        m_allEntries.removeLast();
+        ++evicted;
+    }
+
+    // Nothing changed — skip the stats/chart/table update entirely
+    if (newEntries.isEmpty() && evicted == 0) return;
+
+    // Prepend oldest first so the batch keeps its newest-first order; only
+    // the added and evicted rows touch the indexes and totals
+    for (auto it = newEntries.crbegin(); it != newEntries.crend(); ++it) {
+        m_allEntries.prepend(*it);
+        --m_rowOrigin;
+        bootsChanged |= indexRow(m_rowOrigin, *it, true);
+        unitsChanged |= m_totals.add(*it, bucketUsec());
     }
 
-    m_criticalLabel->setText(QString::number(critical));
-    m_errorLabel->setText(QString::number(error));
-    m_warningLabel->setText(QString::number(warning));
-    m_threatsLabel->setText(QString::number(threats));
-    m_totalLabel->setText(QString::number(m_allEntries.size()));
+    // A selected boot or unit that aged out resets its selector, which
+    // rescopes every row
+    const bool bootKept = !bootsChanged || updateBootFilter();
+    const bool unitKept = !unitsChanged || updateUnitFilter();
+    if (!bootKept || !unitKept) {
+        updateStats();
+        updateCharts();
+        applyFilters();
+        return;
+    }
+
+    // Evicted rows leave the tail of the filtered rows, matching new ones
+    // join at the head
+    const qint64 lastRow = m_rowOrigin + m_allEntries.size() - 1;
+    while (!m_filteredRows.isEmpty() && m_filteredRows.last() > lastRow)
+        m_filteredRows.removeLast();
+    const Filter filter = currentFilter();
+    int added = 0;
+    for (qint64 row = m_rowOrigin + newEntries.size() - 1; row >= m_rowOrigin; --row) {
+        if (!matches(entryAt(row), filter)) continue;
+        m_filteredRows.prepend(row);
+        ++added;
+    }
+
+    // The template view regroups every filtered row, so it waits for the
+    // coalesced redraw along with the charts
+    updateStats();
+    if (!m_templatesToggle->isChecked()) updateTableHead(added);
+    if (!m_redrawTimer->isActive()) m_redrawTimer->start();
 }
 
-void StatsTab::updateCharts() {
-    // === LEFT: Timeline Chart ===
-    m_timelineChart->chart()->removeAllSeries();
-    for (auto* axis : m_timelineChart->chart()->axes())
-        m_timelineChart->chart()->removeAxis(axis);
+void StatsTab::appendOlderEntries(const QVector<LogEntry>& batch) {
+    if (batch.isEmpty()) return;
 
-    QMap<QString, QVector<int>> timeBuckets;
+    // Older rows go after every existing one, so the indexes only grow
+    const qint64 base = m_rowOrigin + m_allEntries.size();
+    m_allEntries += batch;
+    for (int i = 0; i < batch.size(); ++i) {
+        indexRow(base + i, batch[i], false);
+        m_totals.add(batch[i], bucketUsec());
+    }
+    updateBootFilter();
+    updateStats();
+    updateCharts();
+    updateUnitFilter();
+    applyFilters();
+}
 
-    for (const auto& entry : m_allEntries) {
-        const QString bucket = (m_mode == "live")
-            ? entry.timestamp.toString("hh:00")
-            : entry.timestamp.toString("MM-dd");
+void StatsTab::setBoots(const QVector<JournalBoot>& boots) {
+    m_boots = boots;
+    updateBootFilter();
+}
+
+void StatsTab::rebuildIndexes() {
+    m_rowOrigin = 0;
+    m_bootRows.clear();
+    m_keyRows.clear();
+    m_totals = Totals();
+    for (int i = 0; i < m_allEntries.size(); ++i) {
+        indexRow(i, m_allEntries[i], false);
+        m_totals.add(m_allEntries[i], bucketUsec());
+    }
+}
+
+bool StatsTab::indexRow(qint64 row, const LogEntry& entry, bool front) {
+    auto file = [&](QVector<qint64>& rows) {
+        if (front) rows.prepend(row);
+        else       rows.append(row);
+    };
+    const bool newBoot = !m_bootRows.contains(entry.bootId);
+    file(m_bootRows[entry.bootId]);
+    for (const auto& entity : entry.entities)
+        file(m_keyRows[entity.key()]);
+    if (entry.templateId != 0)
+        file(m_keyRows[QString("template:%1").arg(entry.templateId)]);
+    return newBoot;
+}
+
+bool StatsTab::unindexOldestRow(const LogEntry& entry) {
+    // The oldest row is last in every list it is filed in
+    auto drop = [](QHash<QString, QVector<qint64>>& index, const QString& key) {
+        auto it = index.find(key);
+        if (it == index.end()) return false;
+        it->removeLast();
+        if (!it->isEmpty()) return false;
+        index.erase(it);
+        return true;
+    };
+    for (const auto& entity : entry.entities)
+        drop(m_keyRows, entity.key());
+    if (entry.templateId != 0)
+        drop(m_keyRows, QString("template:%1").arg(entry.templateId));
+    return drop(m_bootRows, entry.bootId);
+}
 
-        if (!timeBuckets.contains(bucket))
-            timeBuckets[bucket] = {0, 0, 0};
+bool StatsTab::Totals::add(const LogEntry& entry, qint64 bucketUsec, int sign) {
+    total += sign;
+    threats += sign * entry.threatCount;
 
-        if      (entry.group == "critical") timeBuckets[bucket][0]++;
-        else if (entry.group == "error")    timeBuckets[bucket][1]++;
-        else if (entry.group == "warning")  timeBuckets[bucket][2]++;
+    const qint64 key = entry.timestampUsec / bucketUsec;
+    auto& bucket = timeBuckets[key];
+    if      (entry.group == "critical") { critical += sign; bucket[0] += sign; }
+    else if (entry.group == "error")    { error += sign;    bucket[1] += sign; }
+    else if (entry.group == "warning")  { warning += sign;  bucket[2] += sign; }
+    bucket[3] += sign;
+    if (bucket[3] == 0) timeBuckets.remove(key);
+
+    if (entry.threatCount > 0) {
+        const QString sev = entry.maxThreatSeverity.isEmpty()
+            ? "unknown" : entry.maxThreatSeverity;
+        if ((threatSeverities[sev] += sign) == 0) threatSeverities.remove(sev);
+    }
+
+    if (entry.unit.isEmpty()) return false;
+    const int count = (units[entry.unit] += sign);
+    if (count == 0) units.remove(entry.unit);
+    return count == 0 || (count == 1 && sign > 0);
+}
+
+qint64 StatsTab::bucketUsec() const {
+    // Hourly buckets for the live window, daily for scans
+    return (m_mode == "live") ? 3600LL * 1000000 : 86400LL * 1000000;
+}
+
+bool StatsTab::updateBootFilter() {
+    // The selector is hidden on the live tab, which always shows every boot
+    if (m_mode == "live") return true;
+
+    const QString current = m_bootFilter->currentData().toString();
+
+    // Newest boot first, by its newest entry
+    QList<QPair<qint64, QString>> order;
+    for (auto it = m_bootRows.cbegin(); it != m_bootRows.cend(); ++it)
+        order.append({entryAt(it.value().first()).timestampUsec, it.key()});
+    std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+    });
+
+    QStringList ids, labels;
+    for (const auto& item : order) {
+        const QString& id = item.second;
+        const QVector<qint64>& rows = m_bootRows[id];
+        qint64 firstUsec = entryAt(rows.last()).timestampUsec;
+        qint64 lastUsec  = entryAt(rows.first()).timestampUsec;
+        QString offset;
+        for (int i = 0; i < m_boots.size(); ++i) {
+            if (!id.isEmpty() && m_boots[i].bootId.startsWith(id)) {
+                offset = QString::number(-i);
+                firstUsec = m_boots[i].firstUsec;
+                lastUsec  = m_boots[i].lastUsec;
+                break;
+            }
+        }
+        auto stamp = [](qint64 usec) {
+            return QDateTime::fromMSecsSinceEpoch(usec / 1000, Qt::UTC).toString("MM-dd hh:mm");
+        };
+        const QString name = id.isEmpty() ? QString("No boot id") : id;
+        ids << id;
+        labels << (offset.isEmpty()
+            ? QString("%1 · %2 – %3 (%4)").arg(name, stamp(firstUsec), stamp(lastUsec)).arg(rows.size())
+            : QString("Boot %1 · %2 – %3 · %4 (%5)")
+                  .arg(offset, stamp(firstUsec), stamp(lastUsec), name).arg(rows.size()));
+    }
+
+    // The same boots in the same order only need their labels touched up,
+    // which leaves an open dropdown and the selection alone
+    bool sameBoots = m_bootFilter->count() == ids.size() + 1;
+    for (int i = 0; sameBoots && i < ids.size(); ++i)
+        sameBoots = m_bootFilter->itemData(i + 1).toString() == ids[i];
+    if (sameBoots) {
+        for (int i = 0; i < labels.size(); ++i) {
+            if (m_bootFilter->itemText(i + 1) != labels[i]) m_bootFilter->setItemText(i + 1, labels[i]);
+        }
+        return true;
     }
 
+    const QSignalBlocker blocker(m_bootFilter);
+    m_bootFilter->clear();
+    m_bootFilter->addItem("All boots", "all");
+    for (int i = 0; i < ids.size(); ++i) m_bootFilter->addItem(labels[i], ids[i]);
+
+    const int idx = m_bootFilter->findData(current);
+    m_bootFilter->setCurrentIndex(idx >= 0 ? idx : 0);
+    return idx >= 0 || current.isEmpty();
+}
+
+QVector<qint64> StatsTab::scopedRows() const {
+    const QString boot = m_bootFilter->currentData().toString();
+    if (boot != "all") return m_bootRows.value(boot);
+
+    QVector<qint64> rows;
+    rows.reserve(m_allEntries.size());
+    for (int i = 0; i < m_allEntries.size(); ++i) rows.append(m_rowOrigin + i);
+    return rows;
+}
+
+QVector<qint64> StatsTab::keyedRows(const QString& key) const {
+    const QString boot = m_bootFilter->currentData().toString();
+    const QVector<qint64> rows = m_keyRows.value(key);
+    if (boot == "all") return rows;
+
+    QVector<qint64> scope;
+    for (const qint64 row : rows)
+        if (entryAt(row).bootId == boot) scope.append(row);
+    return scope;
+}
+
+StatsTab::Totals StatsTab::scopedTotals() const {
+    if (m_bootFilter->currentData().toString() == "all") return m_totals;
+
+    Totals totals;
+    for (const qint64 row : scopedRows())
+        totals.add(entryAt(row), bucketUsec());
+    return totals;
+}
+
+void StatsTab::updateStats() {
+    const Totals totals = scopedTotals();
+    m_criticalLabel->setText(QString::number(totals.critical));
+    m_errorLabel->setText(QString::number(totals.error));
+    m_warningLabel->setText(QString::number(totals.warning));
+    m_threatsLabel->setText(QString::number(totals.threats));
+    m_totalLabel->setText(QString::number(totals.total));
+}
+
+void StatsTab::updateCharts() {
+    const Totals totals = scopedTotals();
+
+    // === LEFT: Timeline Chart ===
+    m_timelineChart->chart()->removeAllSeries();
+    for (auto* axis : m_timelineChart->chart()->axes())
+        m_timelineChart->chart()->removeAxis(axis);
+
     auto* criticalSeries = new QBarSet("Critical");
     auto* errorSeries    = new QBarSet("Error");
     auto* warningSeries  = new QBarSet("Warning");
@@ -435,9 +722,13 @@ void StatsTab::updateCharts() {
     errorSeries->setColor(QColor("#FF6B35"));
     warningSeries->setColor(QColor("#FFD60A"));
 
+    // Buckets are integer hour/day indexes; a QDateTime is only built per
+    // bucket label, not per entry
+    const qint64 bucketUsec = this->bucketUsec();
     QStringList categories;
-    for (auto it = timeBuckets.begin(); it != timeBuckets.end(); ++it) {
-        categories << it.key();
+    for (auto it = totals.timeBuckets.begin(); it != totals.timeBuckets.end(); ++it) {
+        const QDateTime start = QDateTime::fromMSecsSinceEpoch(it.key() * (bucketUsec / 1000), Qt::UTC);
+        categories << start.toString(m_mode == "live" ? "hh:00" : "MM-dd");
         *criticalSeries << it.value()[0];
         *errorSeries    << it.value()[1];
         *warningSeries  << it.value()[2];
@@ -464,15 +755,7 @@ void StatsTab::updateCharts() {
     // === CENTER: Threat Severity Donut Chart ===
     m_donutChart->chart()->removeAllSeries();
 
-    QMap<QString, int> threatCounts;
-    for (const auto& entry : m_allEntries) {
-        if (entry.threatCount > 0) {
-            const QString sev = entry.maxThreatSeverity.isEmpty()
-                ? "unknown" : entry.maxThreatSeverity;
-            threatCounts[sev]++;
-        }
-    }
-
+    const QMap<QString, int>& threatCounts = totals.threatSeverities;
     if (!threatCounts.isEmpty()) {
         auto* pieSeries = new QPieSeries();
         for (auto it = threatCounts.begin(); it != threatCounts.end(); ++it) {
@@ -499,15 +782,9 @@ void StatsTab::updateCharts() {
     for (auto* axis : m_unitsChart->chart()->axes())
         m_unitsChart->chart()->removeAxis(axis);
 
-    QMap<QString, int> unitCounts;
-    for (const auto& entry : m_allEntries) {
-        if (!entry.unit.isEmpty() && entry.unit != "unknown")
-            unitCounts[entry.unit]++;
-    }
-
     QList<QPair<int, QString>> sorted;
-    for (auto it = unitCounts.begin(); it != unitCounts.end(); ++it)
-        sorted.append({it.value(), it.key()});
+    for (auto it = totals.units.begin(); it != totals.units.end(); ++it)
+        if (it.key() != "unknown") sorted.append({it.value(), it.key()});
     std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
         return a.first > b.first;
     });
@@ -541,87 +818,196 @@ void StatsTab::updateCharts() {
     }
 }
 
-void StatsTab::updateUnitFilter() {
+bool StatsTab::updateUnitFilter() {
     const QString current = m_unitFilter->currentData().toString();
+    const QSignalBlocker blocker(m_unitFilter);
     m_unitFilter->clear();
     m_unitFilter->addItem("All units", "all");
 
-    QSet<QString> units;
-    for (const auto& entry : m_allEntries)
-        if (!entry.unit.isEmpty()) units.insert(entry.unit);
+    // m_totals counts every unit of m_allEntries
+    for (auto it = m_totals.units.cbegin(); it != m_totals.units.cend(); ++it)
+        m_unitFilter->addItem(it.key(), it.key());
 
-    for (const QString& unit : units)
-        m_unitFilter->addItem(unit, unit);
-
-    int idx = m_unitFilter->findData(current);
+    const int idx = m_unitFilter->findData(current);
     if (idx >= 0) m_unitFilter->setCurrentIndex(idx);
+    return idx >= 0 || current.isEmpty();
 }
 
-void StatsTab::applyFilters() {
-    m_filteredEntries.clear();
-
-    QString groupFilter = "all";
-    if      (m_filterCritical->isChecked()) groupFilter = "critical";
-    else if (m_filterError->isChecked())    groupFilter = "error";
-    else if (m_filterWarning->isChecked())  groupFilter = "warning";
-    else if (m_filterThreats->isChecked())  groupFilter = "threats";
-
-    const QString unitFilter = m_unitFilter->currentData().toString();
-    const QString search     = m_searchBox->text().toLower();
-
-    for (const auto& entry : m_allEntries) {
-        if (groupFilter != "all") {
-            if (groupFilter == "threats") {
-                if (entry.threatCount == 0) continue;
-            } else if (entry.group != groupFilter) {
-                continue;
-            }
-        }
+StatsTab::Filter StatsTab::currentFilter() const {
+    Filter filter;
+    filter.group = "all";
+    if      (m_filterCritical->isChecked()) filter.group = "critical";
+    else if (m_filterError->isChecked())    filter.group = "error";
+    else if (m_filterWarning->isChecked())  filter.group = "warning";
+    else if (m_filterThreats->isChecked())  filter.group = "threats";
+
+    filter.unit = m_unitFilter->currentData().toString();
+    filter.boot = m_bootFilter->currentData().toString();
+
+    // "ip:10.0.0.1", "template:12" and friends come from the index, not a
+    // text scan
+    const QString text = m_searchBox->text().trimmed();
+    LogEntity entity;
+    if (LogEntity::parse(text, entity)) filter.key = entity.key();
+    else if (text.startsWith("template:")) filter.key = text;
+    if (filter.key.isEmpty()) filter.search = m_searchBox->text().toLower();
+    return filter;
+}
 
-        if (unitFilter != "all" && entry.unit != unitFilter) continue;
+bool StatsTab::matches(const LogEntry& entry, const Filter& filter) const {
+    if (filter.boot != "all" && entry.bootId != filter.boot) return false;
 
-        if (!search.isEmpty()) {
-            if (!entry.message.toLower().contains(search) &&
-                !entry.unit.toLower().contains(search)    &&
-                !entry.exe.toLower().contains(search)     &&
-                !entry.cmdline.toLower().contains(search)) {
-                continue;
-            }
+    if (filter.group != "all") {
+        if (filter.group == "threats") {
+            if (entry.threatCount == 0) return false;
+        } else if (entry.group != filter.group) {
+            return false;
         }
+    }
+
+    if (filter.unit != "all" && entry.unit != filter.unit) return false;
 
-        m_filteredEntries.append(entry);
+    if (!filter.key.isEmpty()) {
+        bool keyed = filter.key == QString("template:%1").arg(entry.templateId);
+        for (const auto& entity : entry.entities)
+            keyed = keyed || entity.key() == filter.key;
+        if (!keyed) return false;
+    }
+
+    if (!filter.search.isEmpty()) {
+        if (!entry.message.toLower().contains(filter.search) &&
+            !entry.unit.toLower().contains(filter.search)    &&
+            !entry.exe.toLower().contains(filter.search)     &&
+            !entry.cmdline.toLower().contains(filter.search)) {
+            return false;
+        }
     }
+    return true;
+}
+
+void StatsTab::applyFilters() {
+    m_filteredRows.clear();
+
+    const Filter filter = currentFilter();
+    const QVector<qint64> scope = filter.key.isEmpty() ? scopedRows() : keyedRows(filter.key);
+    for (const qint64 row : scope)
+        if (matches(entryAt(row), filter)) m_filteredRows.append(row);
 
-    updateTable();
+    if (m_templatesToggle->isChecked()) updateTemplateTable();
+    else                                updateTable();
+}
+
+void StatsTab::fillTableRow(int tableRow, qint64 row) {
+    const LogEntry& entry = entryAt(row);
+
+    m_table->setItem(tableRow, 0,  new QTableWidgetItem(entry.dateTime().toString("yyyy-MM-dd HH:mm:ss UTC")));
+    m_table->setItem(tableRow, 1,  new QTableWidgetItem(entry.threatBadge()));
+    m_table->setItem(tableRow, 2,  new QTableWidgetItem(entry.severityLabel()));
+    m_table->setItem(tableRow, 3,  new QTableWidgetItem(QString::number(entry.priority)));
+    m_table->setItem(tableRow, 4,  new QTableWidgetItem(entry.source));
+    m_table->setItem(tableRow, 5,  new QTableWidgetItem(entry.unit));
+    m_table->setItem(tableRow, 6,  new QTableWidgetItem(entry.pid));
+    m_table->setItem(tableRow, 7,  new QTableWidgetItem(entry.exe.section('/', -1)));
+    m_table->setItem(tableRow, 8,  new QTableWidgetItem(entry.hostname));
+    m_table->setItem(tableRow, 9,  new QTableWidgetItem(entry.bootId));
+    m_table->setItem(tableRow, 10, new QTableWidgetItem(entry.message.left(300)));
+    // The table may be sorted, so each row carries its own key
+    m_table->item(tableRow, 0)->setData(Qt::UserRole, row);
+
+    for (int col = 0; col < m_table->columnCount(); ++col) {
+        auto* item = m_table->item(tableRow, col);
+        item->setBackground(QBrush(entry.severityBgColor()));
+        item->setForeground(QBrush(entry.severityColor()));
+    }
 }
 
 void StatsTab::updateTable() {
-    m_table->setRowCount(qMin(m_filteredEntries.size(), 2000));
-
-    for (int i = 0; i < m_table->rowCount(); ++i) {
-        const auto& entry = m_filteredEntries[i];
-
-        m_table->setItem(i, 0,  new QTableWidgetItem(entry.timestamp.toString("yyyy-MM-dd HH:mm:ss UTC")));
-        m_table->setItem(i, 1,  new QTableWidgetItem(entry.threatBadge()));
-        m_table->setItem(i, 2,  new QTableWidgetItem(entry.severityLabel()));
-        m_table->setItem(i, 3,  new QTableWidgetItem(QString::number(entry.priority)));
-        m_table->setItem(i, 4,  new QTableWidgetItem(entry.source));
-        m_table->setItem(i, 5,  new QTableWidgetItem(entry.unit));
-        m_table->setItem(i, 6,  new QTableWidgetItem(entry.pid));
-        m_table->setItem(i, 7,  new QTableWidgetItem(entry.exe.section('/', -1)));
-        m_table->setItem(i, 8,  new QTableWidgetItem(entry.hostname));
-        m_table->setItem(i, 9,  new QTableWidgetItem(entry.bootId));
-        m_table->setItem(i, 10, new QTableWidgetItem(entry.message.left(300)));
-
-        for (int col = 0; col < m_table->columnCount(); ++col) {
-            auto* item = m_table->item(i, col);
-            item->setBackground(QBrush(entry.severityBgColor()));
-            item->setForeground(QBrush(entry.severityColor()));
-        }
+    // Sorting stays off while filling so rows don't move under setItem
+    m_table->setSortingEnabled(false);
+    m_table->setRowCount(qMin(int(m_filteredRows.size()), kMaxTableRows));
+    for (int i = 0; i < m_table->rowCount(); ++i)
+        fillTableRow(i, m_filteredRows[i]);
+    m_table->setSortingEnabled(true);
+
+    updateRowCount();
+}
+
+void StatsTab::updateTableHead(int added) {
+    m_table->setSortingEnabled(false);
+
+    // The table shows the newest kMaxTableRows filtered rows: drop evicted
+    // rows and those pushed past the cap, then insert the new ones on top
+    qint64 limit = m_rowOrigin + m_allEntries.size() - 1;
+    if (m_filteredRows.size() > kMaxTableRows)
+        limit = qMin(limit, m_filteredRows[kMaxTableRows - 1]);
+    for (int i = m_table->rowCount() - 1; i >= 0; --i)
+        if (m_table->item(i, 0)->data(Qt::UserRole).toLongLong() > limit) m_table->removeRow(i);
+    for (int i = qMin(added, kMaxTableRows) - 1; i >= 0; --i) {
+        m_table->insertRow(0);
+        fillTableRow(0, m_filteredRows[i]);
     }
 
+    m_table->setSortingEnabled(true);
+    updateRowCount();
+}
+
+void StatsTab::updateRowCount() {
     m_rowCountLabel->setText(QString("%1 rows (of %2 total)")
-                             .arg(m_filteredEntries.size())
+                             .arg(m_filteredRows.size())
+                             .arg(m_allEntries.size()));
+}
+
+void StatsTab::updateTemplateTable() {
+    struct Row {
+        quint32         id = 0;
+        int             count = 0;
+        qint64          firstUsec = 0;
+        qint64          lastUsec = 0;
+        const LogEntry* example = nullptr;
+    };
+    QHash<quint32, Row> byId;
+    for (const qint64 filtered : m_filteredRows) {
+        const LogEntry& entry = entryAt(filtered);
+        Row& row = byId[entry.templateId];
+        if (row.count++ == 0) {
+            row.id = entry.templateId;
+            row.firstUsec = row.lastUsec = entry.timestampUsec;
+            row.example = &entry;
+        }
+        row.firstUsec = qMin(row.firstUsec, entry.timestampUsec);
+        row.lastUsec  = qMax(row.lastUsec, entry.timestampUsec);
+    }
+
+    QVector<Row> rows;
+    rows.reserve(byId.size());
+    for (const auto& row : byId) rows.append(row);
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+        return a.count != b.count ? a.count > b.count : a.id < b.id;
+    });
+
+    auto stamp = [](qint64 usec) {
+        return QDateTime::fromMSecsSinceEpoch(usec / 1000, Qt::UTC).toString("yyyy-MM-dd HH:mm:ss UTC");
+    };
+    m_templateTable->setRowCount(qMin(int(rows.size()), kMaxTableRows));
+    for (int i = 0; i < m_templateTable->rowCount(); ++i) {
+        const Row& row = rows[i];
+        // Entries that were never mined stand for themselves
+        QString pattern = TemplateMiner::shared().find(row.id).pattern;
+        if (row.id == 0 || pattern.isEmpty()) pattern = row.example->message;
+
+        auto* count = new QTableWidgetItem(QString::number(row.count));
+        count->setData(Qt::UserRole, row.id);
+        m_templateTable->setItem(i, 0, count);
+        m_templateTable->setItem(i, 1, new QTableWidgetItem(stamp(row.firstUsec)));
+        m_templateTable->setItem(i, 2, new QTableWidgetItem(stamp(row.lastUsec)));
+        m_templateTable->setItem(i, 3, new QTableWidgetItem(row.id ? QString::number(row.id) : QString("–")));
+        m_templateTable->setItem(i, 4, new QTableWidgetItem(pattern.left(300)));
+        m_templateTable->item(i, 4)->setToolTip(row.example->message);
+    }
+
+    m_rowCountLabel->setText(QString("%1 templates over %2 rows (of %3 total)")
+                             .arg(rows.size())
+                             .arg(m_filteredRows.size())
                              .arg(m_allEntries.size()));
 }
 
@@ -633,6 +1019,12 @@ void StatsTab::onFilterChanged() {
     applyFilters();
 }
 
+void StatsTab::onBootChanged() {
+    updateStats();
+    updateCharts();
+    applyFilters();
+}
+
 void StatsTab::onStatCardClicked(const QString& severity) {
     if      (severity == "critical") m_filterCritical->setChecked(true);
     else if (severity == "error")    m_filterError->setChecked(true);
@@ -667,8 +1059,9 @@ bool StatsTab::eventFilter(QObject* obj, QEvent* event) {
 }
 
 void StatsTab::onRowClicked(int row) {
-    if (row < 0 || row >= m_filteredEntries.size()) return;
-    showDetail(m_filteredEntries[row]);
+    const auto* item = m_table->item(row, 0);
+    if (!item) return;
+    showDetail(entryAt(item->data(Qt::UserRole).toLongLong()));
 }
 
 void StatsTab::showDetail(const LogEntry& entry) {
@@ -682,7 +1075,7 @@ void StatsTab::showDetail(const LogEntry& entry) {
         <b>Executable:</b> %6<br>
         <b>Command Line:</b><br><pre style='background:#0a0a10;padding:8px;'>%7</pre>
         <b>Full Message:</b><br><pre style='background:#0a0a10;padding:8px;border-left:4px solid %8;'>%9</pre>
-    )").arg(entry.timestamp.toString("yyyy-MM-dd HH:mm:ss UTC"),
+    )").arg(entry.dateTime().toString("yyyy-MM-dd HH:mm:ss UTC"),
             entry.severityLabel(),
             QString::number(entry.priority),
             entry.unit,
@@ -692,6 +1085,29 @@ void StatsTab::showDetail(const LogEntry& entry) {
             entry.severityColor().name(),
             entry.message);
 
+    if (!entry.subsystem.isEmpty() || !entry.device.isEmpty()) {
+        html += QString("<b>Kernel Device:</b> %1 %2<br>")
+                    .arg(entry.subsystem.toHtmlEscaped(), entry.device.toHtmlEscaped());
+    }
+
+    if (!entry.entities.isEmpty()) {
+        QStringList links;
+        for (const auto& entity : entry.entities) {
+            links << QString("<a href='entity:%1' style='color:#5AC8FA;'>%2</a>")
+                         .arg(QString::fromLatin1(QUrl::toPercentEncoding(entity.key())),
+                              entity.key().toHtmlEscaped());
+        }
+        html += QString("<b>Entities:</b> %1<br>").arg(links.join(" "));
+    }
+
+    if (entry.templateId != 0) {
+        const QString key = QString("template:%1").arg(entry.templateId);
+        html += QString("<b>Template:</b> <a href='entity:%1' style='color:#5AC8FA;'>#%2</a> %3<br>")
+                    .arg(QString::fromLatin1(QUrl::toPercentEncoding(key)),
+                         QString::number(entry.templateId),
+                         TemplateMiner::shared().find(entry.templateId).pattern.toHtmlEscaped());
+    }
+
     if (entry.threatCount > 0) {
         html += "<br><b style='color:#FF2D55;'>SECURITY THREATS DETECTED:</b><br>";
         for (const auto& threat : entry.threats) {
@@ -716,6 +1132,37 @@ void StatsTab::onCloseDetail() {
     m_detailPanel->setVisible(false);
 }
 
+void StatsTab::onTemplatesToggled(bool on) {
+    m_table->setVisible(!on);
+    m_templateTable->setVisible(on);
+    if (on) m_detailPanel->setVisible(false);
+    applyFilters();
+}
+
+void StatsTab::onTemplateClicked(int row) {
+    const auto* item = m_templateTable->item(row, 0);
+    if (!item) return;
+    const quint32 id = item->data(Qt::UserRole).toUInt();
+    if (id == 0) return;
+
+    // Back to the rows, narrowed to this template
+    {
+        const QSignalBlocker blocker(m_templatesToggle);
+        m_templatesToggle->setChecked(false);
+    }
+    m_table->setVisible(true);
+    m_templateTable->setVisible(false);
+    const QString key = QString("template:%1").arg(id);
+    if (m_searchBox->text() == key) applyFilters();
+    else                            m_searchBox->setText(key);
+}
+
+void StatsTab::onEntityClicked(const QUrl& link) {
+    if (link.scheme() != "entity") return;
+    // textChanged re-filters through the entity index
+    m_searchBox->setText(QUrl::fromPercentEncoding(link.path(QUrl::FullyEncoded).toUtf8()));
+}
+
 void StatsTab::onExportCSV() {
     const QString filename = QFileDialog::getSaveFileName(
         this, "Export CSV",
@@ -732,9 +1179,10 @@ void StatsTab::onExportCSV() {
     QTextStream out(&file);
     out << "Timestamp,Threats,Severity,Priority,Source,Unit,PID,Executable,Host,Boot,Message\n";
 
-    for (const auto& entry : m_filteredEntries) {
+    for (const qint64 row : m_filteredRows) {
+        const LogEntry& entry = entryAt(row);
         out << QString("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10,\"%11\"\n")
-                   .arg(entry.timestamp.toString("yyyy-MM-dd HH:mm:ss"),
+                   .arg(entry.dateTime().toString("yyyy-MM-dd HH:mm:ss"),
                         entry.threatBadge(),
                         entry.severityLabel(),
                         QString::number(entry.priority),
@@ -8,13 +8,16 @@
 #include <QRadioButton>
 #include <QComboBox>
 #include <QLineEdit>
-#include <QTextEdit>
+#include <QTextBrowser>
 #include <QPushButton>
 #include <QTimer>
 #include <QtCharts/QChart>
 #include <QtCharts/QChartView>
 #include <QHBoxLayout>
+#include <QHash>
+#include <QMap>
 #include <QMouseEvent>
+#include <array>
 
 class StatsTab : public QWidget {
     Q_OBJECT
@@ -23,6 +26,17 @@ public:
     explicit StatsTab(const QString& mode, QWidget* parent = nullptr);
 
     void setData(const QVector<LogEntry>& entries);
+
+    // Incremental update for the live tab: prepends newEntries (newest
+    // first) and evicts entries older than evictBefore from the tail.
+    void appendEntries(const QVector<LogEntry>& newEntries, const QDateTime& evictBefore);
+    // Streaming scan: appends a batch that is older than everything already
+    // shown (scan batches arrive newest-first).
+    void appendOlderEntries(const QVector<LogEntry>& batch);
+    // Journal boot index (newest first) used to label the boot selector with
+    // journalctl-style offsets and each boot's full span. Boots found only in
+    // the data are still listed, spanning their own entries.
+    void setBoots(const QVector<JournalBoot>& boots);
     void startLiveUpdates(int intervalMs);
     void stopLiveUpdates();
 
@@ -35,8 +49,12 @@ signals:
 
 private slots:
     void onFilterChanged();
+    void onBootChanged();
     void onRowClicked(int row);
     void onCloseDetail();
+    void onEntityClicked(const QUrl& link);
+    void onTemplatesToggled(bool on);
+    void onTemplateClicked(int row);
     void onExportCSV();
     void onStatCardClicked(const QString& severity);
     void onChartPointClicked(const QString& chartType, const QVariant& data);
@@ -44,8 +62,12 @@ private slots:
 private:
     QString             m_mode;
     QVector<LogEntry>   m_allEntries;
-    QVector<LogEntry>   m_filteredEntries;
+    // Row keys (see m_rowOrigin) of the entries passing the filters, newest first
+    QVector<qint64>     m_filteredRows;
     QTimer*             m_refreshTimer;
+    // Coalesces the chart and template view redraws of live deliveries,
+    // which otherwise arrive every frame
+    QTimer*             m_redrawTimer;
 
     // Stat cards (outer container widgets)
     QWidget* m_criticalCard;
@@ -71,12 +93,55 @@ private:
     QRadioButton* m_filterWarning;
     QRadioButton* m_filterThreats;
     QComboBox*    m_unitFilter;
+    QComboBox*    m_bootFilter;
     QLineEdit*    m_searchBox;
     QLabel*       m_rowCountLabel;
 
     QTableWidget* m_table;
+    QPushButton*  m_templatesToggle;
+    // One row per message template of the filtered entries, in place of
+    // m_table while m_templatesToggle is checked
+    QTableWidget* m_templateTable;
     QWidget*      m_detailPanel;
-    QTextEdit*    m_detailContent;
+    QTextBrowser* m_detailContent;
+
+    // The indexes below hold row keys rather than positions: m_allEntries[i]
+    // is row m_rowOrigin + i, and prepending live entries lowers the origin,
+    // so no indexed row moves
+    qint64 m_rowOrigin = 0;
+    // Rows per 8-character boot id, each newest first, so switching boots
+    // touches only that boot's entries
+    QHash<QString, QVector<qint64>> m_bootRows;
+    QVector<JournalBoot>            m_boots;
+    // Rows per entity key ("ip:10.0.0.1") and per template ("template:12"),
+    // ascending, so such a search jumps straight to the entries it names
+    QHash<QString, QVector<qint64>> m_keyRows;
+
+    // Counts behind the stat cards, charts and unit filter
+    struct Totals {
+        int critical = 0, error = 0, warning = 0, threats = 0, total = 0;
+        // Critical, error and warning entries per time bucket, then all entries
+        QMap<qint64, std::array<int, 4>> timeBuckets;
+        QMap<QString, int> threatSeverities;
+        QMap<QString, int> units;
+        // Counts entry in (sign 1) or back out (sign -1); true when that
+        // adds or drops a unit
+        bool add(const LogEntry& entry, qint64 bucketUsec, int sign = 1);
+    };
+    // Totals of all of m_allEntries, moved by each added and evicted row; a
+    // selected boot is tallied on demand
+    Totals m_totals;
+
+    // The table filters as currently set
+    struct Filter {
+        QString group;
+        QString unit;
+        QString boot;
+        QString search;  // lower-case text, empty when key is used
+        QString key;     // entity or template key from the search box
+    };
+
+    static constexpr int kMaxTableRows = 2000;
 
     void setupUI();
     QHBoxLayout* createStatCards();
@@ -88,9 +153,33 @@ private:
     void updateStats();
     void updateCharts();
     void updateTable();
-    void updateUnitFilter();
+    void updateTemplateTable();
+    // Both return false when the selected unit or boot is gone and the
+    // selector fell back to all of them
+    bool updateUnitFilter();
+    bool updateBootFilter();
+    void updateRowCount();
+    // Refills the table head after a live delivery prepended `added`
+    // filtered rows and evicted older ones
+    void updateTableHead(int added);
+    void fillTableRow(int tableRow, qint64 row);
+    void rebuildIndexes();
+    // Files row under its boot, entities and template, at the front of each
+    // list or the back; true when it opens a new boot
+    bool indexRow(qint64 row, const LogEntry& entry, bool front);
+    // Drops the oldest row, which is entry; true when its boot empties
+    bool unindexOldestRow(const LogEntry& entry);
+    const LogEntry& entryAt(qint64 row) const { return m_allEntries[int(row - m_rowOrigin)]; }
+    qint64 bucketUsec() const;
+    // Rows of the selected boot, or all of them
+    QVector<qint64> scopedRows() const;
+    // Rows of the selected boot under key, from m_keyRows
+    QVector<qint64> keyedRows(const QString& key) const;
+    Totals scopedTotals() const;
     void showDetail(const LogEntry& entry);
 
+    Filter currentFilter() const;
+    bool matches(const LogEntry& entry, const Filter& filter) const;
     void applyFilters();
 
     // createStatCard installs an event filter on the card widget.
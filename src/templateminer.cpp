@@ -0,0 +1,252 @@
+#include "templateminer.h"
+#include <algorithm>
+#include <numeric>
+
+TemplateMiner::TemplateMiner(int depth, double similarity, int maxChildren, int maxClusters)
+    : m_depth(qMax(3, depth)), m_similarity(similarity), m_maxChildren(qMax(2, maxChildren)),
+      m_maxClusters(qMax(1, maxClusters)) {}
+
+TemplateMiner& TemplateMiner::shared() {
+    static TemplateMiner miner;
+    return miner;
+}
+
+QStringList TemplateMiner::tokenize(const QString& message) {
+    QStringList tokens;
+    int start = -1;
+    bool digit = false;
+    for (int i = 0; i <= message.size(); ++i) {
+        if (i == message.size() || message[i].isSpace()) {
+            if (start >= 0) tokens.append(digit ? wildcard() : message.mid(start, i - start));
+            start = -1;
+            continue;
+        }
+        if (start < 0) {
+            start = i;
+            digit = false;
+        }
+        if (message[i].isDigit()) digit = true;
+    }
+    return tokens;
+}
+
+quint32 TemplateMiner::add(const QString& message, qint64 usec) {
+    const QStringList tokens = tokenize(message);
+
+    QMutexLocker locker(&m_mutex);
+    return assign(tokens, message, usec);
+}
+
+void TemplateMiner::annotate(QVector<LogEntry>& entries, const QVector<QStringList>& tokens) {
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < entries.size(); ++i)
+        entries[i].templateId = assign(tokens[i], entries[i].message, entries[i].timestampUsec);
+}
+
+quint32 TemplateMiner::assign(const QStringList& tokens, const QString& message, qint64 usec) {
+    const int leaf = leafFor(tokens, false);
+    int index = leaf >= 0 ? bestCluster(leaf, tokens) : -1;
+    if (index >= 0) {
+        Cluster& cluster = m_clusters[index];
+        bool changed = false;
+        for (int i = 0; i < tokens.size(); ++i) {
+            if (cluster.tokens[i] != tokens[i] && cluster.tokens[i] != wildcard()) {
+                cluster.tokens[i] = wildcard();
+                changed = true;
+            }
+        }
+        if (changed) cluster.info.pattern = cluster.tokens.join(' ');
+    } else {
+        if (m_clusters.size() >= m_maxClusters) evictStalest();
+        // The search may have followed a <*> child where adding makes a
+        // node of its own
+        const int target = leafFor(tokens, true);
+        index = newCluster(m_nextId++, tokens);
+        m_nodes[target].clusters.append(index);
+    }
+
+    Cluster& cluster = m_clusters[index];
+    cluster.touched = ++m_tick;
+    record(cluster, message, usec);
+    return cluster.info.id;
+}
+
+int TemplateMiner::leafFor(const QStringList& tokens, bool create) {
+    int node;
+    const auto length = m_byLength.constFind(tokens.size());
+    if (length != m_byLength.constEnd()) {
+        node = length.value();
+    } else if (!create) {
+        return -1;
+    } else {
+        node = m_nodes.size();
+        m_nodes.append(Node());
+        m_byLength.insert(tokens.size(), node);
+    }
+
+    const int levels = qMin(m_depth - 2, int(tokens.size()));
+    for (int level = 0; level < levels; ++level) {
+        const QHash<QString, int>& children = m_nodes[node].children;
+        const auto exact = children.constFind(tokens[level]);
+        if (exact != children.constEnd()) {
+            node = exact.value();
+            continue;
+        }
+        const auto any = children.constFind(wildcard());
+        if (!create) {
+            if (any == children.constEnd()) return -1;
+            node = any.value();
+            continue;
+        }
+
+        // A new token gets a child of its own while there is room, the
+        // last slot being kept for <*>
+        const bool room = any != children.constEnd() ? children.size() < m_maxChildren
+                                                     : children.size() + 1 < m_maxChildren;
+        const QString key = room ? tokens[level] : wildcard();
+        const auto existing = children.constFind(key);
+        if (existing != children.constEnd()) {
+            node = existing.value();
+            continue;
+        }
+        const int child = m_nodes.size();
+        m_nodes[node].children.insert(key, child);
+        m_nodes.append(Node());
+        node = child;
+    }
+    return node;
+}
+
+int TemplateMiner::bestCluster(int leaf, const QStringList& tokens) const {
+    int best = -1;
+    double bestSimilarity = -1;
+    int bestParams = -1;
+    for (const int index : m_nodes[leaf].clusters) {
+        const QStringList& pattern = m_clusters[index].tokens;
+        int same = 0, params = 0;
+        for (int i = 0; i < pattern.size(); ++i) {
+            if (pattern[i] == tokens[i]) ++same;
+            if (pattern[i] == wildcard()) ++params;
+        }
+        const double similarity = pattern.isEmpty() ? 1.0 : double(same) / pattern.size();
+        // On a tie the more general template wins
+        if (similarity > bestSimilarity || (similarity == bestSimilarity && params > bestParams)) {
+            best = index;
+            bestSimilarity = similarity;
+            bestParams = params;
+        }
+    }
+    return bestSimilarity >= m_similarity ? best : -1;
+}
+
+void TemplateMiner::record(Cluster& cluster, const QString& message, qint64 usec) {
+    LogTemplate& info = cluster.info;
+    if (info.count == 0 || usec < info.firstUsec) info.firstUsec = usec;
+    if (info.count == 0 || usec > info.lastUsec) info.lastUsec = usec;
+    ++info.count;
+    if (info.examples.size() < kMaxExamples) {
+        const QString example = message.left(kMaxExampleLength);
+        if (!info.examples.contains(example)) info.examples.append(example);
+    }
+}
+
+int TemplateMiner::newCluster(quint32 id, const QStringList& tokens) {
+    Cluster cluster;
+    cluster.tokens = tokens;
+    cluster.info.id = id;
+    cluster.info.pattern = tokens.join(' ');
+    m_byId.insert(id, m_clusters.size());
+    m_clusters.append(cluster);
+    return m_clusters.size() - 1;
+}
+
+void TemplateMiner::evictStalest() {
+    const int keep = m_maxClusters - qMax(1, m_maxClusters / 10);
+    const int drop = m_clusters.size() - keep;
+    if (drop <= 0) return;
+
+    QVector<int> order(m_clusters.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::nth_element(order.begin(), order.begin() + (drop - 1), order.end(), [this](int a, int b) {
+        const Cluster& x = m_clusters[a];
+        const Cluster& y = m_clusters[b];
+        return x.touched != y.touched ? x.touched < y.touched : x.info.id < y.info.id;
+    });
+    QVector<bool> doomed(m_clusters.size(), false);
+    for (int i = 0; i < drop; ++i) doomed[order[i]] = true;
+    compact(doomed);
+}
+
+void TemplateMiner::compact(const QVector<bool>& doomed) {
+    // Old cluster index -> new one, -1 once removed
+    QVector<int> moved(m_clusters.size(), -1);
+    int kept = 0;
+    for (int i = 0; i < m_clusters.size(); ++i) {
+        if (doomed[i]) {
+            m_byId.remove(m_clusters[i].info.id);
+            continue;
+        }
+        if (kept != i) {
+            m_clusters[kept] = std::move(m_clusters[i]);
+            m_byId.insert(m_clusters[kept].info.id, kept);
+        }
+        moved[i] = kept++;
+    }
+    m_clusters.resize(kept);
+
+    for (Node& node : m_nodes) {
+        QVector<int>& clusters = node.clusters;
+        clusters.erase(std::remove_if(clusters.begin(), clusters.end(),
+                                      [&moved](int index) { return moved[index] < 0; }),
+                       clusters.end());
+        for (int& index : clusters) index = moved[index];
+    }
+}
+
+LogTemplate TemplateMiner::find(quint32 id) const {
+    QMutexLocker locker(&m_mutex);
+    const auto it = m_byId.constFind(id);
+    return it != m_byId.constEnd() ? m_clusters[it.value()].info : LogTemplate();
+}
+
+QVector<LogTemplate> TemplateMiner::templates() const {
+    QVector<LogTemplate> all;
+    {
+        QMutexLocker locker(&m_mutex);
+        all.reserve(m_clusters.size());
+        for (const auto& cluster : m_clusters) all.append(cluster.info);
+    }
+    std::sort(all.begin(), all.end(), [](const LogTemplate& a, const LogTemplate& b) {
+        return a.count != b.count ? a.count > b.count : a.id < b.id;
+    });
+    return all;
+}
+
+int TemplateMiner::templateCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_clusters.size();
+}
+
+void TemplateMiner::restore(const QVector<LogTemplate>& stored) {
+    QMutexLocker locker(&m_mutex);
+    for (const auto& info : stored) {
+        if (info.id == 0 || m_byId.contains(info.id)) continue;
+        const QStringList tokens = info.pattern.split(' ', Qt::SkipEmptyParts);
+        const int leaf = leafFor(tokens, true);
+        const int index = newCluster(info.id, tokens);
+        m_clusters[index].info = info;
+        m_nodes[leaf].clusters.append(index);
+        m_nextId = qMax(m_nextId, info.id + 1);
+    }
+    if (m_clusters.size() > m_maxClusters) evictStalest();
+}
+
+void TemplateMiner::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_nodes.clear();
+    m_byLength.clear();
+    m_clusters.clear();
+    m_byId.clear();
+    m_nextId = 1;
+    m_tick = 0;
+}
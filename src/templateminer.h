@@ -0,0 +1,119 @@
+#ifndef TEMPLATEMINER_H
+#define TEMPLATEMINER_H
+
+#include "logentry.h"
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// One message shape: the tokens every message of the cluster shares, with
+// the positions that varied replaced by <*>.
+struct LogTemplate {
+    quint32     id = 0;           // 0 = no template
+    QString     pattern;          // tokens joined by single spaces
+    qint64      count = 0;
+    qint64      firstUsec = 0;
+    qint64      lastUsec = 0;
+    QStringList examples;         // the first few distinct messages
+};
+
+// Online log template mining after Drain (He et al., ICWS 2017). Messages
+// are split on whitespace and every token holding a digit is masked as <*>
+// up front. A fixed-depth tree then routes a message by its token count and
+// its first depth - 2 tokens to a leaf, where it joins the most similar
+// cluster of the same length (share of positions equal to the template)
+// if that reaches the similarity threshold, or starts a new one. Joining
+// masks the positions that differ. A node never has more than maxChildren
+// children; further tokens share its <*> child, so a field that is not
+// masked but varies anyway (user names, unit names) cannot blow up the
+// tree.
+//
+// Template ids are assigned in order of creation and never change, even as
+// the pattern generalises, so they serve as compact keys for search and
+// storage. shared() is the process-wide miner the collectors use; its ids
+// are what LogEntry::templateId and the database refer to.
+//
+// At most maxClusters templates are kept: reaching the cap evicts the tenth
+// least recently matched, and their ids are not handed out again.
+//
+// Thread-safe: tokenising runs unlocked, the tree behind one mutex. Bulk
+// callers tokenise in parallel and hand the batch to annotate() so the lock
+// is taken once rather than per message.
+class TemplateMiner {
+public:
+    static constexpr int    kDefaultDepth       = 4;
+    static constexpr double kDefaultSimilarity  = 0.5;
+    static constexpr int    kDefaultMaxChildren = 100;
+    static constexpr int    kDefaultMaxClusters = 5000;
+    static constexpr int    kMaxExamples        = 3;
+    static constexpr int    kMaxExampleLength   = 512;
+
+    explicit TemplateMiner(int depth = kDefaultDepth, double similarity = kDefaultSimilarity,
+                           int maxChildren = kDefaultMaxChildren,
+                           int maxClusters = kDefaultMaxClusters);
+
+    static TemplateMiner& shared();
+    static QString wildcard() { return QStringLiteral("<*>"); }
+
+    // Assigns message to a template and returns its id (never 0)
+    quint32 add(const QString& message, qint64 usec = 0);
+    void annotate(LogEntry& entry) { entry.templateId = add(entry.message, entry.timestampUsec); }
+    // Same for every entry, given tokens[i] == tokenize(entries[i].message)
+    void annotate(QVector<LogEntry>& entries, const QVector<QStringList>& tokens);
+
+    // The template with id, or one with id 0 when there is none
+    LogTemplate find(quint32 id) const;
+    // Every template, most frequent first
+    QVector<LogTemplate> templates() const;
+    int templateCount() const;
+
+    // Re-creates stored templates under their ids so new messages of the
+    // same shape keep them; ids already in use are left alone
+    void restore(const QVector<LogTemplate>& stored);
+    void clear();
+
+    // Whitespace-separated tokens, any token with a digit replaced by <*>
+    static QStringList tokenize(const QString& message);
+
+private:
+    struct Node {
+        QHash<QString, int> children;   // token -> node index
+        QVector<int>        clusters;   // at leaves: indices into m_clusters
+    };
+    struct Cluster {
+        QStringList tokens;
+        LogTemplate info;
+        quint64     touched = 0;   // m_tick of the last match, 0 if restored
+    };
+
+    // add() with the lock held; returns the template id
+    quint32 assign(const QStringList& tokens, const QString& message, qint64 usec);
+
+    // Leaf for tokens; with create, missing nodes are added following the
+    // maxChildren rule, else -1 when the path does not exist
+    int leafFor(const QStringList& tokens, bool create);
+    int bestCluster(int leaf, const QStringList& tokens) const;
+    void record(Cluster& cluster, const QString& message, qint64 usec);
+    int newCluster(quint32 id, const QStringList& tokens);
+    // Evicts the least recently matched tenth of the clusters
+    void evictStalest();
+    // Removes the clusters flagged in doomed, re-indexing the rest
+    void compact(const QVector<bool>& doomed);
+
+    const int    m_depth;
+    const double m_similarity;
+    const int    m_maxChildren;
+    const int    m_maxClusters;
+
+    mutable QMutex       m_mutex;
+    QVector<Node>        m_nodes;
+    QHash<int, int>      m_byLength;     // token count -> node index
+    QVector<Cluster>     m_clusters;
+    QHash<quint32, int>  m_byId;         // template id -> cluster index
+    quint32              m_nextId = 1;
+    quint64              m_tick = 0;
+};
+
+#endif // TEMPLATEMINER_H
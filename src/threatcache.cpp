@@ -0,0 +1,75 @@
+#include "threatcache.h"
+
+ThreatCache::ThreatCache(int capacity)
+    : m_shardCapacity(capacity > 0 ? qMax(1, (capacity + kShards - 1) / kShards) : 0),
+      m_shards(new Shard[kShards]) {}
+
+bool ThreatCache::lookup(quint64 key, QVector<ThreatMatch>& threats) {
+    if (!isEnabled()) return false;
+
+    Shard& shard = shardFor(key);
+    {
+        QMutexLocker locker(&shard.mutex);
+        const auto it = shard.index.constFind(key);
+        if (it != shard.index.constEnd()) {
+            Slot& slot = shard.slots[it.value()];
+            slot.referenced = true;
+            threats = slot.threats;
+            locker.unlock();
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void ThreatCache::insert(quint64 key, const QVector<ThreatMatch>& threats) {
+    if (!isEnabled()) return;
+
+    Shard& shard = shardFor(key);
+    QMutexLocker locker(&shard.mutex);
+    // Another thread may have missed on the same key and got here first
+    if (shard.index.contains(key)) return;
+
+    if (shard.slots.size() < m_shardCapacity) {
+        shard.index.insert(key, shard.slots.size());
+        shard.slots.append({key, threats, false});
+        return;
+    }
+
+    // Every slot referenced since the hand last passed gets a second chance
+    while (shard.slots[shard.hand].referenced) {
+        shard.slots[shard.hand].referenced = false;
+        shard.hand = (shard.hand + 1) % m_shardCapacity;
+    }
+    Slot& victim = shard.slots[shard.hand];
+    shard.index.remove(victim.key);
+    victim = {key, threats, false};
+    shard.index.insert(key, shard.hand);
+    shard.hand = (shard.hand + 1) % m_shardCapacity;
+}
+
+void ThreatCache::clear() {
+    for (int i = 0; i < kShards; ++i) {
+        Shard& shard = m_shards[i];
+        QMutexLocker locker(&shard.mutex);
+        shard.index.clear();
+        shard.slots.clear();
+        shard.hand = 0;
+    }
+    m_hits.store(0, std::memory_order_relaxed);
+    m_misses.store(0, std::memory_order_relaxed);
+}
+
+ThreatCacheStats ThreatCache::stats() const {
+    ThreatCacheStats stats;
+    stats.hits = m_hits.load(std::memory_order_relaxed);
+    stats.misses = m_misses.load(std::memory_order_relaxed);
+    stats.capacity = m_shardCapacity * kShards;
+    for (int i = 0; i < kShards; ++i) {
+        QMutexLocker locker(&m_shards[i].mutex);
+        stats.size += m_shards[i].slots.size();
+    }
+    return stats;
+}
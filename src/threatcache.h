@@ -0,0 +1,62 @@
+#ifndef THREATCACHE_H
+#define THREATCACHE_H
+
+#include "logentry.h"
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+struct ThreatCacheStats {
+    quint64 hits     = 0;
+    quint64 misses   = 0;
+    int     size     = 0;
+    int     capacity = 0;
+};
+
+// Bounded map from a 64-bit message key to the threats detected for it.
+// Keys are spread over independently locked shards so detection threads
+// rarely contend; each shard evicts with the CLOCK policy (a hit sets the
+// slot's reference bit, the hand clears bits until it finds an unset one).
+// Stored vectors are implicitly shared, so a hit hands out a reference to
+// the cached result rather than a copy of its matches.
+//
+// Keys are trusted: two messages with the same key share a result. With
+// 64-bit keys and a cache of this size a collision is vanishingly rare.
+class ThreatCache {
+public:
+    static constexpr int kShards = 64;
+
+    // capacity 0 disables the cache: lookups miss without being counted
+    explicit ThreatCache(int capacity);
+
+    bool lookup(quint64 key, QVector<ThreatMatch>& threats);
+    void insert(quint64 key, const QVector<ThreatMatch>& threats);
+    void clear();
+
+    bool isEnabled() const { return m_shardCapacity > 0; }
+    ThreatCacheStats stats() const;
+
+private:
+    struct Slot {
+        quint64              key = 0;
+        QVector<ThreatMatch> threats;
+        bool                 referenced = false;
+    };
+    struct Shard {
+        mutable QMutex        mutex;
+        QHash<quint64, int>   index;    // key -> slot
+        QVector<Slot>         slots;    // grows to the shard capacity
+        int                   hand = 0;
+    };
+
+    Shard& shardFor(quint64 key) { return m_shards[key % kShards]; }
+
+    int                      m_shardCapacity;
+    std::unique_ptr<Shard[]> m_shards;
+    std::atomic<quint64>     m_hits{0};
+    std::atomic<quint64>     m_misses{0};
+};
+
+#endif // THREATCACHE_H
@@ -1,7 +1,15 @@
 #include "threatdetector.h"
+#include "parallelbatch.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <algorithm>
+#include <atomic>
 #include <QRegularExpression>
 
-QVector<ThreatDetector::ThreatPattern> ThreatDetector::getThreatPatterns() {
+QVector<ThreatDetector::ThreatPattern> ThreatDetector::builtinRules() {
     return {
         {
             "auth_failure",
@@ -11,7 +19,9 @@ QVector<ThreatDetector::ThreatPattern> ThreatDetector::getThreatPatterns() {
                 "failed publickey", "connection closed by.*\\[preauth\\]",
                 "disconnected.*\\[preauth\\]"
             },
-            "high", "Authentication", "Failed authentication attempt"
+            "high", "Authentication", "Failed authentication attempt",
+            // Login and PAM failures never come from the kernel
+            {}, {}, {"!kernel"}
         },
         {
             "privilege_escalation",
@@ -20,7 +30,8 @@ QVector<ThreatDetector::ThreatPattern> ThreatDetector::getThreatPatterns() {
                 "su:.*authentication failure", "granted sudo", "became root",
                 "pkexec.*not authorized"
             },
-            "critical", "Privilege", "Privilege escalation attempt or suspicious sudo activity"
+            "critical", "Privilege", "Privilege escalation attempt or suspicious sudo activity",
+            {}, {}, {"!kernel"}
         },
         {
             "suspicious_network",
@@ -75,20 +86,297 @@ QVector<ThreatDetector::ThreatPattern> ThreatDetector::getThreatPatterns() {
     };
 }
 
-QVector<ThreatMatch> ThreatDetector::detectThreats(const QString& message, const QString& unit) {
+bool ThreatDetector::parseRules(const QByteArray& json, QVector<ThreatPattern>& rules, QString* error) {
+    auto fail = [error](const QString& message) {
+        if (error) *error = message;
+        return false;
+    };
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+    if (doc.isNull()) return fail(parseError.errorString());
+    if (!doc.isObject() || !doc.object().value("rules").isArray())
+        return fail("expected an object with a \"rules\" array");
+
+    static const QStringList severities = {"critical", "high", "medium", "low"};
+    QVector<ThreatPattern> parsed;
+    const QJsonArray array = doc.object().value("rules").toArray();
+    for (int i = 0; i < array.size(); ++i) {
+        const QJsonObject object = array[i].toObject();
+        ThreatPattern rule;
+        rule.id          = object.value("id").toString();
+        rule.severity    = object.value("severity").toString();
+        rule.category    = object.value("category").toString();
+        rule.description = object.value("description").toString();
+
+        const QString where = QString("rule %1%2").arg(i)
+            .arg(rule.id.isEmpty() ? QString() : QString(" (%1)").arg(rule.id));
+        if (rule.id.isEmpty()) return fail(where + ": missing id");
+        if (!severities.contains(rule.severity))
+            return fail(where + ": severity must be one of " + severities.join(", "));
+
+        auto readScope = [&](const char* key, QStringList& scope) {
+            for (const QJsonValue& value : object.value(key).toArray()) {
+                const QString glob = value.toString();
+                if (glob.isEmpty() || glob == "!") return false;
+                scope.append(glob);
+            }
+            return true;
+        };
+        if (!readScope("units", rule.units) || !readScope("sources", rule.sources)
+            || !readScope("transports", rule.transports))
+            return fail(where + ": scope entries must be non-empty strings");
+
+        for (const QJsonValue& value : object.value("patterns").toArray()) {
+            const QString pattern = value.toString();
+            const QRegularExpression regex(pattern, QRegularExpression::CaseInsensitiveOption);
+            if (pattern.isEmpty() || !regex.isValid())
+                return fail(QString("%1: bad pattern \"%2\": %3")
+                            .arg(where, pattern, pattern.isEmpty() ? "empty" : regex.errorString()));
+            rule.patterns.append(pattern);
+        }
+        if (rule.patterns.isEmpty()) return fail(where + ": no patterns");
+
+        parsed.append(rule);
+    }
+
+    rules = parsed;
+    return true;
+}
+
+ThreatDetector::ThreatDetector(int cacheCapacity)
+    : ThreatDetector(builtinRules(), cacheCapacity) {}
+
+ThreatDetector::ThreatDetector(const QVector<ThreatPattern>& rules, int cacheCapacity)
+    : m_cache(cacheCapacity) {
+    const auto options = QRegularExpression::CaseInsensitiveOption;
+    for (const auto& rule : rules) {
+        CompiledRule compiled;
+        compiled.rule = rule;
+
+        for (const QString& patternStr : rule.patterns) {
+            compiled.patterns.append(QRegularExpression(patternStr, options));
+            compiled.patterns.last().optimize();
+
+            // Conservative: a digit anywhere, even in {n,m} or \x41, or a
+            // \d / \D class keeps digits in the cache key
+            for (int c = 0; c < patternStr.size(); ++c) {
+                if (patternStr[c].isDigit()
+                    || (patternStr[c] == '\\' && c + 1 < patternStr.size()
+                        && patternStr[c + 1].toLower() == 'd'))
+                    m_digitBlind = false;
+            }
+
+            const QString literal = requiredLiteral(patternStr);
+            compiled.literals.append(literal.isEmpty() ? -1 : m_literals.add(literal));
+        }
+        for (const QString& glob : rule.units)      compiled.units.add(glob);
+        for (const QString& glob : rule.sources)    compiled.sources.add(glob);
+        for (const QString& glob : rule.transports) compiled.transports.add(glob);
+
+        m_rules.append(compiled);
+    }
+    m_literals.build();
+}
+
+void ThreatDetector::Scope::add(const QString& glob) {
+    const bool negated = glob.startsWith('!');
+    const QRegularExpression regex(
+        QRegularExpression::wildcardToRegularExpression(negated ? glob.mid(1) : glob));
+    (negated ? exclude : include).append(regex);
+}
+
+bool ThreatDetector::Scope::admits(const QString& value) const {
+    // Unknown values are not held against a rule
+    if (value.isEmpty()) return true;
+    for (const auto& regex : exclude) {
+        if (regex.match(value).hasMatch()) return false;
+    }
+    if (include.isEmpty()) return true;
+    for (const auto& regex : include) {
+        if (regex.match(value).hasMatch()) return true;
+    }
+    return false;
+}
+
+std::shared_ptr<const ThreatDetector::RuleSet> ThreatDetector::ruleSetFor(
+        const QString& unit, const QString& source, const QString& transport) const {
+    const QString key = unit + QChar(0x1f) + source + QChar(0x1f) + transport;
+    {
+        QReadLocker locker(&m_scopeLock);
+        const auto it = m_scopes.constFind(key);
+        if (it != m_scopes.constEnd()) return it.value();
+    }
+
+    QVector<int> rules;
+    bool allGuarded = true;
+    for (int r = 0; r < m_rules.size(); ++r) {
+        const CompiledRule& compiled = m_rules[r];
+        if (!compiled.units.admits(unit) || !compiled.sources.admits(source)
+            || !compiled.transports.admits(transport))
+            continue;
+        rules.append(r);
+        if (compiled.literals.contains(-1)) allGuarded = false;
+    }
+
+    QWriteLocker locker(&m_scopeLock);
+    std::shared_ptr<const RuleSet>& set = m_ruleSets[rules];
+    if (!set) {
+        auto created = std::make_shared<RuleSet>();
+        created->id = m_ruleSets.size();
+        created->rules = rules;
+        created->allGuarded = allGuarded;
+        set = created;
+    }
+    if (m_scopes.size() < kMaxScopes) m_scopes.insert(key, set);
+    return set;
+}
+
+QString ThreatDetector::requiredLiteral(const QString& pattern) {
+    QString best;
+    QString run;
+    auto endRun = [&]() {
+        if (run.size() > best.size()) best = run;
+        run.clear();
+    };
+
+    for (int i = 0; i < pattern.size(); ++i) {
+        const QChar c = pattern[i];
+        switch (c.unicode()) {
+        case '(': case ')': case '|':
+            // Alternation or groups (also inline options): nothing is
+            // certainly required
+            return QString();
+        case '*': case '?':
+            // The quantified atom may be absent
+            run.chop(1);
+            endRun();
+            break;
+        case '{': {
+            // Counted repetition, possibly {0,n}; its bounds are not text
+            run.chop(1);
+            endRun();
+            const int close = pattern.indexOf('}', i);
+            if (close > i) i = close;
+            break;
+        }
+        case '+':
+            endRun();
+            break;
+        case '[': {
+            endRun();
+            int j = i + 1;
+            if (j < pattern.size() && pattern[j] == '^') ++j;
+            if (j < pattern.size() && pattern[j] == ']') ++j;
+            while (j < pattern.size() && pattern[j] != ']') {
+                if (pattern[j] == '\\') ++j;
+                ++j;
+            }
+            i = j;
+            break;
+        }
+        case '.': case '^': case '$':
+            endRun();
+            break;
+        case '\\':
+            if (i + 1 >= pattern.size()) return QString();
+            ++i;
+            // \b, \d, \x41, ... are classes, assertions or codes; only an
+            // escaped punctuation character is itself
+            if (pattern[i].isLetterOrNumber()) {
+                endRun();
+            } else {
+                run += pattern[i];
+            }
+            break;
+        default:
+            run += c;
+            break;
+        }
+    }
+    endRun();
+
+    return LiteralMatcher::isAscii(best) ? best : QString();
+}
+
+int ThreatDetector::patternCount() const {
+    int count = 0;
+    for (const auto& compiled : m_rules) count += compiled.patterns.size();
+    return count;
+}
+
+// Set up on first use; read and replaced only through std::atomic_load/store
+static std::shared_ptr<const ThreatDetector>& installedDetector() {
+    static std::shared_ptr<const ThreatDetector> detector = std::make_shared<const ThreatDetector>();
+    return detector;
+}
+
+std::shared_ptr<const ThreatDetector> ThreatDetector::current() {
+    return std::atomic_load(&installedDetector());
+}
+
+void ThreatDetector::install(std::shared_ptr<const ThreatDetector> detector) {
+    if (detector) std::atomic_store(&installedDetector(), std::move(detector));
+}
+
+QVector<ThreatMatch> ThreatDetector::detectThreats(const QString& message, const QString& unit,
+                                                   const QString& source, const QString& transport) {
+    return current()->detect(message, unit, source, transport);
+}
+
+QVector<ThreatMatch> ThreatDetector::detect(const QString& message, const QString& unit,
+                                            const QString& source, const QString& transport) const {
+    const std::shared_ptr<const RuleSet> set = ruleSetFor(unit, source, transport);
+    if (set->rules.isEmpty()) return {};
+    if (!m_cache.isEnabled()) return evaluate(message, *set);
+
+    const quint64 key = cacheKey(set->id, message, m_digitBlind);
     QVector<ThreatMatch> threats;
-    QString msgLower = message.toLower();
-    
-    for (const auto& pattern : getThreatPatterns()) {
-        for (const QString& patternStr : pattern.patterns) {
-            QRegularExpression regex(patternStr, QRegularExpression::CaseInsensitiveOption);
-            if (regex.match(msgLower).hasMatch()) {
+    if (m_cache.lookup(key, threats)) return threats;
+
+    threats = evaluate(message, *set);
+    m_cache.insert(key, threats);
+    return threats;
+}
+
+quint64 ThreatDetector::cacheKey(int ruleSet, const QString& message, bool foldDigits) {
+    quint64 hash = 14695981039346656037ULL;
+    auto mix = [&hash](char16_t c) {
+        hash ^= c & 0xFF;
+        hash *= 1099511628211ULL;
+        hash ^= c >> 8;
+        hash *= 1099511628211ULL;
+    };
+    mix(char16_t(ruleSet));
+    mix(char16_t(ruleSet >> 16));
+    for (QChar c : message) {
+        const char16_t u = c.unicode();
+        mix(foldDigits && u >= '1' && u <= '9' ? u'0' : u);
+    }
+    return hash;
+}
+
+QVector<ThreatMatch> ThreatDetector::evaluate(const QString& message, const RuleSet& set) const {
+    QVector<ThreatMatch> threats;
+
+    QVector<bool> hits;
+    if (!m_literals.scan(message, hits) && set.allGuarded) return threats;
+
+    // The patterns are case-insensitive, so the message is matched as is
+    for (int r : set.rules) {
+        const CompiledRule& compiled = m_rules[r];
+        for (int i = 0; i < compiled.patterns.size(); ++i) {
+            const int literal = compiled.literals[i];
+            if (literal >= 0 && !hits[literal]) continue;
+
+            if (compiled.patterns[i].match(message).hasMatch()) {
+                const ThreatPattern& pattern = compiled.rule;
                 threats.append({
                     pattern.id,
                     pattern.severity,
                     pattern.category,
                     pattern.description,
-                    patternStr
+                    pattern.patterns[i]
                 });
                 break; // One match per threat type
             }
@@ -97,3 +385,34 @@ QVector<ThreatMatch> ThreatDetector::detectThreats(const QString& message, const
     
     return threats;
 }
+
+void ThreatDetector::annotate(LogEntry& entry) const {
+    entry.threats = detect(entry.message, entry.unit, entry.source, entry.transport);
+    entry.threatCount = entry.threats.size();
+    entry.maxThreatSeverity = maxSeverity(entry.threats);
+}
+
+void ThreatDetector::detectBatch(LogEntry* begin, LogEntry* end, int workers) const {
+    forEachParallel(begin, end, kBatchChunk, workers, [this](LogEntry& entry) { annotate(entry); });
+}
+
+QString ThreatDetector::maxSeverity(const QVector<ThreatMatch>& threats) {
+    auto rank = [](const QString& severity) {
+        if (severity == "critical") return 0;
+        if (severity == "high")     return 1;
+        if (severity == "medium")   return 2;
+        if (severity == "low")      return 3;
+        return 99;
+    };
+
+    QString max;
+    int maxRank = 99;
+    for (const auto& threat : threats) {
+        const int r = rank(threat.severity);
+        if (r < maxRank) {
+            maxRank = r;
+            max = threat.severity;
+        }
+    }
+    return max;
+}
@@ -2,23 +2,163 @@
 #define THREATDETECTOR_H
 
 #include "logentry.h"
+#include "literalmatcher.h"
+#include "threatcache.h"
+#include <QHash>
+#include <QReadWriteLock>
 #include <QVector>
 #include <QRegularExpression>
+#include <QStringList>
+#include <memory>
 
+// Matches log messages against the threat rule set. The rules are compiled
+// (and JIT-optimised) once, when a ThreatDetector is constructed, and only
+// read afterwards, so one instance can be shared between threads.
+// detectThreats() and the collectors go through the installed detector
+// (current()), which starts out with the built-in rules and is replaced
+// wholesale when a rule file is loaded (see ThreatRuleWatcher).
+//
+// Every pattern a literal can be extracted from is guarded by it: a
+// message is scanned once for all literals, and only patterns whose
+// literal occurs in it are confirmed with their regex. Routine lines
+// containing none of the literals never reach a regex.
+//
+// Rules can be scoped to units, sources and transports. The rules that
+// apply to a (unit, source, transport) combination are worked out once and
+// remembered, so a line only runs the rules meant for it.
+//
+// Results are cached per (applicable rules, message) in a ThreatCache
+// owned by the detector, so the cache lives and dies with the compiled
+// rule set and a changed rule set never sees stale results. When no pattern mentions a
+// digit, every ASCII digit in the message is keyed as 0 and lines that
+// differ only in PIDs, ports or addresses share one entry.
 class ThreatDetector {
 public:
-    static QVector<ThreatMatch> detectThreats(const QString& message, const QString& unit);
-    
-private:
     struct ThreatPattern {
         QString id;
         QVector<QString> patterns;
         QString severity;
         QString category;
         QString description;
+        // Scopes: wildcard globs ("sshd*.service"); a leading ! excludes.
+        // A value passes when it matches no exclusion and, if there are
+        // inclusions, at least one of them. Empty = everything.
+        QStringList units;
+        QStringList sources;      // journald, dmesg
+        QStringList transports;   // kernel, syslog, journal, stdout, audit, ...
+    };
+
+    static constexpr int kDefaultCacheCapacity = 65536;
+
+    // Built-in rules; cacheCapacity 0 disables the result cache
+    explicit ThreatDetector(int cacheCapacity = kDefaultCacheCapacity);
+    // rules must be valid, as parseRules() guarantees
+    explicit ThreatDetector(const QVector<ThreatPattern>& rules,
+                            int cacheCapacity = kDefaultCacheCapacity);
+
+    int ruleCount() const { return m_rules.size(); }
+    int patternCount() const;
+
+    // An empty unit, source or transport is treated as unknown: scopes on
+    // it do not exclude any rule
+    QVector<ThreatMatch> detect(const QString& message, const QString& unit,
+                                const QString& source = QString(),
+                                const QString& transport = QString()) const;
+    // Fills threats, threatCount and maxThreatSeverity of entry, scoped by
+    // its unit, source and transport
+    void annotate(LogEntry& entry) const;
+    // annotate() on every entry in [begin, end), spread over up to workers
+    // threads (0 = QThread::idealThreadCount()) in runs of kBatchChunk
+    // entries; see forEachParallel()
+    void detectBatch(LogEntry* begin, LogEntry* end, int workers = 0) const;
+    void detectBatch(QVector<LogEntry>& entries, int workers = 0) const {
+        detectBatch(entries.data(), entries.data() + entries.size(), workers);
+    }
+
+    static constexpr int kBatchChunk = 64;
+
+    ThreatCacheStats cacheStats() const { return m_cache.stats(); }
+    void clearCache() const { m_cache.clear(); }
+
+    // The detector in use. Holding the returned pointer keeps that rule set
+    // alive, so detection already running is never affected by install().
+    static std::shared_ptr<const ThreatDetector> current();
+    // Atomically replaces the detector returned by current()
+    static void install(std::shared_ptr<const ThreatDetector> detector);
+
+    static QVector<ThreatPattern> builtinRules();
+    // Reads a rule file:
+    //   { "rules": [ { "id": "auth_failure", "severity": "high",
+    //                  "category": "Authentication",
+    //                  "description": "Failed authentication attempt",
+    //                  "patterns": ["failed password", "invalid user"],
+    //                  "units": ["sshd*", "!sshd-keygen*"],
+    //                  "transports": ["!kernel"] } ] }
+    // severity is critical, high, medium or low; patterns are
+    // case-insensitive regular expressions and must all compile. units,
+    // sources and transports are optional scope lists. On failure
+    // rules is left alone and error says what is wrong.
+    static bool parseRules(const QByteArray& json, QVector<ThreatPattern>& rules,
+                           QString* error = nullptr);
+
+    static QVector<ThreatMatch> detectThreats(const QString& message, const QString& unit,
+                                              const QString& source = QString(),
+                                              const QString& transport = QString());
+    // Highest severity among threats, empty if there are none
+    static QString maxSeverity(const QVector<ThreatMatch>& threats);
+
+    // A literal every match of pattern must contain (the longest one found
+    // outside groups, classes and quantified atoms), empty if there is none
+    // or the pattern is not simple enough to tell
+    static QString requiredLiteral(const QString& pattern);
+    
+private:
+    // literals[i] is pattern i's index in m_literals, or -1 when the
+    // pattern has no required literal and always runs
+    struct Scope {
+        QVector<QRegularExpression> include;
+        QVector<QRegularExpression> exclude;
+
+        void add(const QString& glob);
+        bool admits(const QString& value) const;
     };
+
+    struct CompiledRule {
+        ThreatPattern               rule;
+        QVector<QRegularExpression> patterns;
+        QVector<int>                literals;
+        Scope                       units;
+        Scope                       sources;
+        Scope                       transports;
+    };
+
+    // Indexes into m_rules of the rules that apply to one scope; id tells
+    // distinct sets apart in the result cache key
+    struct RuleSet {
+        int          id = 0;
+        QVector<int> rules;
+        bool         allGuarded = true;
+    };
+    // Scope table entries kept; beyond this, new scopes are resolved per call
+    static constexpr int kMaxScopes = 4096;
     
-    static QVector<ThreatPattern> getThreatPatterns();
+    std::shared_ptr<const RuleSet> ruleSetFor(const QString& unit, const QString& source,
+                                              const QString& transport) const;
+    // Runs the set's rules, bypassing the cache
+    QVector<ThreatMatch> evaluate(const QString& message, const RuleSet& set) const;
+    // FNV-1a over the rule set id and message, digits folded to 0 if foldDigits
+    static quint64 cacheKey(int ruleSet, const QString& message, bool foldDigits);
+
+    QVector<CompiledRule> m_rules;
+    LiteralMatcher        m_literals;
+    bool                  m_digitBlind = true;  // no pattern can tell digits apart
+    mutable ThreatCache   m_cache;
+
+    // "unit\x1fsource\x1ftransport" -> applicable rules. Rule sets are shared
+    // between scopes with the same rules, so their results share cache slots.
+    mutable QReadWriteLock                                    m_scopeLock;
+    mutable QHash<QString, std::shared_ptr<const RuleSet>>   m_scopes;
+    mutable QHash<QVector<int>, std::shared_ptr<const RuleSet>> m_ruleSets;
 };
 
 #endif // THREATDETECTOR_H
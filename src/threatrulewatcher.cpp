@@ -0,0 +1,104 @@
+#include "threatrulewatcher.h"
+#include "threatdetector.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QStandardPaths>
+#include <QTimer>
+
+ThreatRuleWatcher::ThreatRuleWatcher(const QString& path, QObject* parent)
+    : QObject(parent)
+    , m_path(QFileInfo(path).absoluteFilePath())
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_debounce(new QTimer(this))
+{
+    // One compile at a time; a newer load supersedes rather than races
+    m_compilePool.setMaxThreadCount(1);
+
+    // A save usually arrives as several notifications in a row
+    m_debounce->setSingleShot(true);
+    m_debounce->setInterval(200);
+    connect(m_debounce, &QTimer::timeout, this, &ThreatRuleWatcher::reload);
+
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, [this]() {
+        watch();
+        m_debounce->start();
+    });
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+        // Other files in the config dir change too; only a new or replaced
+        // rules file matters
+        const bool watchedFile = m_watcher->files().contains(m_path);
+        // A missing config dir is waited for from the nearest ancestor, so
+        // this may be one more level of it appearing
+        watch();
+        const QFileInfo info(m_path);
+        if (!info.exists()) return;
+        if (watchedFile && info.lastModified() == m_loadedModified) return;
+        m_debounce->start();
+    });
+}
+
+ThreatRuleWatcher::~ThreatRuleWatcher() {
+    // The compile job posts its result back to this object
+    m_compilePool.waitForDone();
+}
+
+QString ThreatRuleWatcher::defaultRulesPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/threat-rules.json";
+}
+
+void ThreatRuleWatcher::start() {
+    watch();
+    if (QFileInfo::exists(m_path)) reload();
+}
+
+void ThreatRuleWatcher::watch() {
+    // The nearest directory on the path that exists; the watcher never
+    // creates the config dir itself
+    QString dir = QFileInfo(m_path).absolutePath();
+    while (!QFileInfo(dir).isDir()) {
+        const QString parent = QFileInfo(dir).absolutePath();
+        if (parent == dir) break;
+        dir = parent;
+    }
+    const QStringList stale = m_watcher->directories();
+    for (const QString& watched : stale) {
+        if (watched != dir) m_watcher->removePath(watched);
+    }
+    if (!m_watcher->directories().contains(dir)) m_watcher->addPath(dir);
+    if (QFileInfo::exists(m_path) && !m_watcher->files().contains(m_path)) m_watcher->addPath(m_path);
+}
+
+void ThreatRuleWatcher::reload() {
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (file.exists()) emit rulesError(QString("%1: %2").arg(m_path, file.errorString()));
+        return;
+    }
+    const QByteArray json = file.readAll();
+    m_loadedModified = QFileInfo(m_path).lastModified();
+    const quint64 generation = ++m_generation;
+
+    m_compilePool.start([this, json, generation]() {
+        QElapsedTimer timer;
+        timer.start();
+        QVector<ThreatDetector::ThreatPattern> rules;
+        QString error;
+        std::shared_ptr<const ThreatDetector> detector;
+        if (ThreatDetector::parseRules(json, rules, &error))
+            detector = std::make_shared<const ThreatDetector>(rules);
+        const qint64 compileMs = timer.elapsed();
+
+        QMetaObject::invokeMethod(this, [this, detector, error, generation, compileMs]() {
+            // A later save is already compiling
+            if (generation != m_generation) return;
+            if (!detector) {
+                emit rulesError(QString("%1: %2").arg(m_path, error));
+                return;
+            }
+            ThreatDetector::install(detector);
+            emit rulesReloaded(detector->ruleCount(), detector->patternCount(), compileMs);
+        }, Qt::QueuedConnection);
+    });
+}
@@ -0,0 +1,58 @@
+#ifndef THREATRULEWATCHER_H
+#define THREATRULEWATCHER_H
+
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+class QFileSystemWatcher;
+class QTimer;
+
+// Loads the threat rules from a JSON file (format: ThreatDetector::parseRules)
+// and reloads them whenever the file changes. Parsing and compiling happen
+// on a worker thread; the finished detector is installed with
+// ThreatDetector::install(), so detection in progress keeps the rule set it
+// started with and never sees a half-built one. A missing or broken file
+// leaves the rules in use as they are.
+//
+// The directory is watched as well as the file: editors that save by
+// writing a new file and renaming it over the old one drop the file watch,
+// and a file created after start() is picked up the same way. While the
+// directory does not exist yet, its nearest existing ancestor is watched
+// instead, following the path down as it is created.
+class ThreatRuleWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ThreatRuleWatcher(const QString& path = defaultRulesPath(), QObject* parent = nullptr);
+    // Waits for a compile still running
+    ~ThreatRuleWatcher();
+
+    // <XDG config>/error-dashboard/threat-rules.json
+    static QString defaultRulesPath();
+
+    QString path() const { return m_path; }
+    // Loads the file if it exists and starts watching
+    void start();
+    // Queues a load of the file now; an older load still compiling is
+    // discarded when it finishes
+    void reload();
+
+signals:
+    // A new rule set was installed
+    void rulesReloaded(int ruleCount, int patternCount, qint64 compileMs);
+    void rulesError(const QString& error);
+
+private:
+    void watch();
+
+    QString             m_path;
+    QFileSystemWatcher* m_watcher;
+    QTimer*             m_debounce;
+    QThreadPool         m_compilePool;
+    quint64             m_generation = 0;
+    QDateTime           m_loadedModified;   // of the file last read
+};
+
+#endif // THREATRULEWATCHER_H